@@ -42,6 +42,11 @@ struct BuildSettings
     bool         shouldDumpDebugInfo() const               { return getWithDefault (debugMember, false); }
     bool         isDebugFlagSet() const                    { return getWithDefault (debugMember, false); }
     bool         shouldUseFastMaths() const                { return getOptimisationLevel() >= 4; }
+    bool         shouldOptimiseStateLayout() const         { return getWithDefault (optimiseStateLayoutMember, false); }
+    bool         shouldPackNodeArrays() const              { return getWithDefault (packNodeArraysMember, false); }
+    bool         shouldUseApproximateMaths() const         { return getWithDefault (approximateMathsMember, false); }
+    bool         shouldTimePasses() const                  { return getWithDefault (timePassesMember, false); }
+    bool         shouldProfileNodes() const                { return getWithDefault (profileNodesMember, false); }
     std::string  getMainProcessor() const                  { return getWithDefault (mainProcessorMember, ""); }
 
     BuildSettings& setMaxFrequency (double f)              { setProperty (maxFrequencyMember, f); return *this; }
@@ -55,6 +60,11 @@ struct BuildSettings
     BuildSettings& setSessionID (int32_t id)               { setProperty (sessionIDMember, id); return *this; }
     BuildSettings& setDebugFlag (bool b)                   { setProperty (debugMember, b); return *this; }
     BuildSettings& setMainProcessor (std::string_view s)   { setProperty (mainProcessorMember, s); return *this; }
+    BuildSettings& setOptimiseStateLayout (bool b)         { setProperty (optimiseStateLayoutMember, b); return *this; }
+    BuildSettings& setPackNodeArrays (bool b)              { setProperty (packNodeArraysMember, b); return *this; }
+    BuildSettings& setApproximateMaths (bool b)            { setProperty (approximateMathsMember, b); return *this; }
+    BuildSettings& setTimePasses (bool b)                  { setProperty (timePassesMember, b); return *this; }
+    BuildSettings& setProfileNodes (bool b)                { setProperty (profileNodesMember, b); return *this; }
 
     void reset()                                           { settings = choc::value::Value(); }
 
@@ -127,6 +137,11 @@ private:
     static constexpr auto ignoreWarningsMember     = "ignoreWarnings";
     static constexpr auto debugMember              = "debug";
     static constexpr auto mainProcessorMember      = "mainProcessor";
+    static constexpr auto optimiseStateLayoutMember = "optimiseStateLayout";
+    static constexpr auto packNodeArraysMember     = "packNodeArrays";
+    static constexpr auto approximateMathsMember   = "approximateMaths";
+    static constexpr auto timePassesMember         = "timePasses";
+    static constexpr auto profileNodesMember       = "profileNodes";
 
     template <typename Type>
     Type getWithDefault (std::string_view name, Type defaultValue) const
@@ -144,12 +144,21 @@ struct Engine
     /// load/link calls.
     std::string getLastBuildLog() const;
 
+    /// If the timePasses build setting is enabled, this returns a JSON string containing
+    /// the measurements made during the last load/link calls - see the PassTimings class
+    /// for details. Otherwise it returns an empty string.
+    std::string getLastPassTimings() const;
+
     //==============================================================================
     /// Holds the results created by the generateCode() method.
     struct CodeGenOutput
     {
         std::string generatedCode, mainClassName;
         DiagnosticMessageList messages;
+
+        /// The engine's build log and pass timings, as returned by getLastBuildLog()
+        /// and getLastPassTimings() after generating the code
+        std::string buildLog, passTimings;
     };
 
     /// Attempts to generate some code from the currently-loaded program, producing
@@ -410,6 +419,15 @@ inline std::string Engine::getLastBuildLog() const
     return {};
 }
 
+inline std::string Engine::getLastPassTimings() const
+{
+    if (engine != nullptr)
+        if (auto result = choc::com::StringPtr (engine->getLastPassTimings()))
+            return result;
+
+    return {};
+}
+
 inline Engine::CodeGenOutput Engine::generateCode (const std::string& targetType, const std::string& options) const
 {
     struct Callback
@@ -432,6 +450,8 @@ inline Engine::CodeGenOutput Engine::generateCode (const std::string& targetType
     CodeGenOutput output;
     engine->generateCode (targetType.c_str(), options.c_str(),
                           std::addressof (output), Callback::handleResult);
+    output.buildLog = getLastBuildLog();
+    output.passTimings = getLastPassTimings();
     return output;
 }
 
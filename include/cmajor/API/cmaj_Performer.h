@@ -183,6 +183,15 @@ struct Performer
     /// If there has been a runtime error, this returns the message, or nullptr if there isn't one.
     const char* getRuntimeError() const;
 
+    /// If the program was linked with BuildSettings::setProfileNodes() enabled, this returns the
+    /// names of the graph nodes whose CPU usage is being measured. Otherwise it returns an empty list.
+    std::vector<std::string> getProfiledNodeNames() const;
+
+    /// Copies the total number of nanoseconds that each of the nodes listed by getProfiledNodeNames()
+    /// has spent running since the performer was reset, and returns the number of values written.
+    /// This is realtime-safe, so can be called on the rendering thread between calls to advance().
+    uint32_t getNodeProfile (uint64_t* totalNanoseconds, uint32_t maxNumNodes) const;
+
     //==============================================================================
     /// The underlying performer that this helper object is wrapping.
     PerformerPtr performer;
@@ -371,5 +380,22 @@ inline double Performer::getLatency() const             { return performer->getL
 inline uint32_t Performer::getEventBufferSize() const   { return performer->getEventBufferSize(); }
 inline const char* Performer::getRuntimeError() const   { return performer != nullptr ? performer->getRuntimeError() : nullptr; }
 
+inline std::vector<std::string> Performer::getProfiledNodeNames() const
+{
+    std::vector<std::string> result;
+
+    if (performer != nullptr)
+        if (auto names = performer->getProfiledNodeNames())
+            for (auto name : choc::json::parse (names))
+                result.push_back (std::string (name.getString()));
+
+    return result;
+}
+
+inline uint32_t Performer::getNodeProfile (uint64_t* totalNanoseconds, uint32_t maxNumNodes) const
+{
+    return performer != nullptr ? performer->getNodeProfile (totalNanoseconds, maxNumNodes) : 0;
+}
+
 
 } // namespace cmaj
@@ -49,9 +49,25 @@ struct Program
     /// provide the filename and content. (The filename is needed so that the compiler
     /// can use it in error message locations, but you can pass an empty string if the
     /// code isn't from a file).
+    /// If you provide a cache, it will be used to avoid re-parsing any files whose content
+    /// has been parsed before.
     bool parse (DiagnosticMessageList& messages,
                 const std::string& filename,
-                const std::string& fileContent);
+                const std::string& fileContent,
+                CacheDatabaseInterface* optionalCache = nullptr);
+
+    /// The name and content of a source file, for use with parseFiles()
+    struct File
+    {
+        std::string filename, content;
+    };
+
+    /// Parses a set of files and adds them to the current program. This has the same
+    /// result as calling parse() for each of them in turn, but may be faster because
+    /// the files can be parsed in parallel.
+    bool parseFiles (DiagnosticMessageList& messages,
+                     const std::vector<File>& files,
+                     CacheDatabaseInterface* optionalCache = nullptr);
 
     /// Returns a JSON version of the current syntax tree.
     std::string getSyntaxTree (const SyntaxTreeOptions&) const;
@@ -87,7 +103,8 @@ inline void Program::reset()
 
 inline bool Program::parse (DiagnosticMessageList& messages,
                             const std::string& filename,
-                            const std::string& fileContent)
+                            const std::string& fileContent,
+                            CacheDatabaseInterface* cache)
 {
     if (program == nullptr)
     {
@@ -95,7 +112,34 @@ inline bool Program::parse (DiagnosticMessageList& messages,
         library = Library::getSharedLibraryPtr();
     }
 
-    if (auto result = choc::com::StringPtr (program->parse (filename.c_str(), fileContent.data(), fileContent.length())))
+    if (auto result = choc::com::StringPtr (program->parse (filename.c_str(), fileContent.data(), fileContent.length(), cache)))
+        return messages.addFromJSONString (result);
+
+    return true;
+}
+
+inline bool Program::parseFiles (DiagnosticMessageList& messages,
+                                 const std::vector<File>& files,
+                                 CacheDatabaseInterface* cache)
+{
+    if (program == nullptr)
+    {
+        program = Library::createProgram();
+        library = Library::getSharedLibraryPtr();
+    }
+
+    std::vector<const char*> filenames, contents;
+    std::vector<size_t> sizes;
+
+    for (auto& f : files)
+    {
+        filenames.push_back (f.filename.c_str());
+        contents.push_back (f.content.data());
+        sizes.push_back (f.content.length());
+    }
+
+    if (auto result = choc::com::StringPtr (program->parseFiles (static_cast<uint32_t> (files.size()),
+                                                                 filenames.data(), contents.data(), sizes.data(), cache)))
         return messages.addFromJSONString (result);
 
     return true;
@@ -125,6 +125,11 @@ struct EngineInterface   : public choc::com::Object
     /// load/link calls.
     [[nodiscard]] virtual choc::com::String* getLastBuildLog() = 0;
 
+    /// If the timePasses build setting is enabled, this returns a JSON object containing
+    /// the measurements made during the last load/link calls - see the PassTimings class
+    /// for details. Otherwise it returns nullptr.
+    [[nodiscard]] virtual choc::com::String* getLastPassTimings() = 0;
+
     //==============================================================================
     /// Returns true if a program has been successfully loaded, but not yet linked.
     virtual bool isLoaded() = 0;
@@ -118,6 +118,9 @@ struct PerformerInterface   : public choc::com::Object
     /// This function must only be called on the rendering thread, after a call to advance().
     /// The handle must have been obtained by calling getEndpointHandle() before the program is linked.
     /// After calling advance(), this can be called to fetch events that were sent to the given endpoint.
+    /// The valueData pointer refers to the performer's own preallocated storage, and is only valid
+    /// during the callback. Events are only unpacked into that storage for the endpoints that are
+    /// iterated, so there's no cost for endpoints that the caller doesn't read.
     virtual void iterateOutputEvents (EndpointHandle, void* context, HandleOutputEventCallback) = 0;
 
     /// Resets the processor.
@@ -147,6 +150,17 @@ struct PerformerInterface   : public choc::com::Object
 
     /// If there has been a runtime error, this returns the message, or nullptr if there isn't one.
     virtual const char* getRuntimeError() = 0;
+
+    /// If the program was linked with BuildSettings::setProfileNodes() enabled, this returns a JSON
+    /// array containing the names of the graph nodes whose CPU usage is being measured. If profiling
+    /// isn't enabled or isn't supported by this engine, it returns nullptr.
+    virtual const char* getProfiledNodeNames() = 0;
+
+    /// If node profiling is enabled, this copies the total number of nanoseconds that each of the
+    /// nodes listed by getProfiledNodeNames() has spent running since the performer was reset,
+    /// and returns the number of values that were written.
+    /// This doesn't allocate or lock, so can be called on the rendering thread between calls to advance().
+    virtual uint32_t getNodeProfile (uint64_t* totalNanoseconds, uint32_t maxNumNodes) = 0;
 };
 
 using PerformerPtr = choc::com::Ptr<PerformerInterface>;
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "../../choc/containers/choc_COM.h"
+#include "cmaj_CacheDatabaseInterface.h"
 
 #ifdef __clang__
  #pragma clang diagnostic push
@@ -59,12 +60,26 @@ struct ProgramInterface  : public choc::com::Object
 
     /// Parses some content, and returns either a nullptr or a JSON-encoded error
     /// that can be parsed with DiagnosticMessageList::fromJSONString()
+    /// If a cache is provided, the program will use it to store and re-load the parsed
+    /// modules, keyed by a hash of the file content. The program also keeps hold of the
+    /// cache so that it can use it again if it needs to re-parse its files later.
     [[nodiscard]] virtual choc::com::String* parse (const char* filename,
                                                     const char* fileContent,
-                                                    size_t fileContentSize) = 0;
+                                                    size_t fileContentSize,
+                                                    CacheDatabaseInterface* optionalCache) = 0;
 
     /// Returns a JSON version of the current syntax tree.
     [[nodiscard]] virtual choc::com::String* getSyntaxTree (const SyntaxTreeOptions&) = 0;
+
+    /// Parses a set of files, and returns either a nullptr or a JSON-encoded error.
+    /// The files may be lexed and parsed in parallel, but their modules are added to the
+    /// program in the order given, and the result is the same as calling parse() on each
+    /// of them in turn.
+    [[nodiscard]] virtual choc::com::String* parseFiles (uint32_t numFiles,
+                                                         const char* const* filenames,
+                                                         const char* const* fileContents,
+                                                         const size_t* fileContentSizes,
+                                                         CacheDatabaseInterface* optionalCache) = 0;
 };
 
 using ProgramPtr = choc::com::Ptr<ProgramInterface>;
@@ -56,6 +56,20 @@ struct AudioMIDIPerformer
     using OutputEventsReadyFn = std::function<void()>;
     using OutputEventHandlerFn = std::function<void(uint64_t frame, std::string_view endpointID, const choc::value::ValueView&)>;
 
+    /// The single-precision block type used by process()
+    using Block = choc::audio::AudioMIDIBlockDispatcher::Block;
+
+    /// A double-precision equivalent of choc::audio::AudioMIDIBlockDispatcher::Block, which
+    /// can be passed to process() by hosts that render in 64-bit. Patches which use float64
+    /// stream endpoints can then be fed without any conversion to single-precision.
+    struct DoublePrecisionBlock
+    {
+        choc::buffer::ChannelArrayView<const double> audioInput;
+        choc::buffer::ChannelArrayView<double> audioOutput;
+        choc::span<const choc::midi::ShortMessage> midiMessages;
+        choc::audio::AudioMIDIBlockDispatcher::HandleMIDIMessageFn onMidiOutputMessage;
+    };
+
     //==============================================================================
     // To create an AudioMIDIPerformer, create a Builder object, set up its connections,
     // and then call Builder::createPerformer() to get the performer object.
@@ -90,13 +104,25 @@ struct AudioMIDIPerformer
         std::unique_ptr<AudioMIDIPerformer> result;
         std::vector<bool> audioOutputChannelsUsed;
 
+        template <typename SampleType>
+        void addInputCopyFunction (EndpointHandle, uint32_t numChannelsInEndpoint,
+                                   const std::vector<uint32_t>& inputChannels,
+                                   const std::vector<uint32_t>& endpointChannels,
+                                   std::shared_ptr<AudioDataListener> listener);
         template <typename SampleType>
         void addOutputCopyFunction (EndpointHandle, uint32_t numChannelsInEndpoint,
                                     const std::vector<uint32_t>& endpointChannels,
                                     const std::vector<uint32_t>& outputChannels,
                                     std::shared_ptr<AudioDataListener> listener);
+        template <typename SampleType>
+        void addDirectOutputCopyFunction (EndpointHandle, const std::vector<uint32_t>& destChannels,
+                                          std::shared_ptr<AudioDataListener> listener);
         void createOutputChannelClearAction();
-        void ensureInputScratchBufferChannelCount (uint32_t);
+
+        // Adds a generic lambda to the function lists for both sample precisions
+        template <typename Fn> void addPreRenderFunction (Fn&&);
+        template <typename Fn> void addPostRenderReplaceFunction (Fn&&);
+        template <typename Fn> void addPostRenderAddFunction (Fn&&);
     };
 
     //==============================================================================
@@ -115,7 +141,14 @@ struct AudioMIDIPerformer
 
     /// If 'replace' is true, it overwrites the output buffer and clears any channels that
     /// aren't in use. If false, it will add the output to whatever is already in the buffer.
-    bool process (const choc::audio::AudioMIDIBlockDispatcher::Block&, bool replaceOutput);
+    ///
+    /// The input and output may refer to the same channel data for in-place processing:
+    /// all input channels are passed to the performer before any output is written.
+    bool process (const Block&, bool replaceOutput);
+
+    /// Processes a block of double-precision audio. Endpoints with float64 data are fed
+    /// directly from (and render directly into) the host buffers.
+    bool process (const DoublePrecisionBlock&, bool replaceOutput);
 
     /// This version of process will automatically chop up a set of MIDI events with frame
     /// times into sub-blocks, and process each chunk separately
@@ -127,6 +160,15 @@ struct AudioMIDIPerformer
                                      const choc::audio::AudioMIDIBlockDispatcher::HandleMIDIMessageFn& sendMidiOut,
                                      bool replaceOutput);
 
+    /// A double-precision version of processWithTimeStampedMIDI()
+    bool processWithTimeStampedMIDI (const choc::buffer::ChannelArrayView<const double> audioInput,
+                                     const choc::buffer::ChannelArrayView<double> audioOutput,
+                                     const choc::midi::ShortMessage* midiInMessages,
+                                     const int* midiInMessageTimes,
+                                     uint32_t totalNumMIDIMessages,
+                                     const choc::audio::AudioMIDIBlockDispatcher::HandleMIDIMessageFn& sendMidiOut,
+                                     bool replaceOutput);
+
     /// Call this after processing ends, to clean up and release resources
     void playbackStopped();
 
@@ -146,16 +188,23 @@ private:
     //==============================================================================
     EndpointTypeCoercionHelperList endpointTypeCoercionHelpers;
 
-    std::vector<std::function<void(const choc::audio::AudioMIDIBlockDispatcher::Block&)>> preRenderFunctions,
-                                                                                          postRenderReplaceFunctions,
-                                                                                          postRenderAddFunctions;
+    template <typename BlockType>
+    struct RenderFunctions
+    {
+        std::vector<std::function<void(const BlockType&)>> preRender, postRenderReplace, postRenderAdd;
+    };
+
+    RenderFunctions<Block> renderFunctions32;
+    RenderFunctions<DoublePrecisionBlock> renderFunctions64;
+
     std::vector<cmaj::EndpointHandle> midiInputEndpoints, midiOutputEndpoints;
     std::vector<std::pair<cmaj::EndpointHandle, std::string>> eventOutputHandles;
     std::unordered_map<std::string, EndpointHandle> inputEndpointHandles;
     choc::fifo::VariableSizeFIFO inputQueue, outputQueue;
     OutputEventsReadyFn outputEventsReadyHandler;
     std::vector<std::pair<choc::midi::ShortMessage, uint32_t>> midiOutputMessages;
-    choc::buffer::InterleavingScratchBuffer<float> audioInputScratchBuffer;
+    choc::buffer::InterleavingScratchBuffer<float> audioInputScratchBuffer32;
+    choc::buffer::InterleavingScratchBuffer<double> audioInputScratchBuffer64;
     std::vector<uint8_t> audioOutputScratchSpace;
 
     uint64_t numFramesProcessed = 0;
@@ -171,7 +220,32 @@ private:
     AudioMIDIPerformer (cmaj::Engine, uint32_t eventFIFOSize);
 
     void allocateScratch();
-    void dispatchMIDIOutputEvents (const choc::audio::AudioMIDIBlockDispatcher::Block&);
+    template <typename BlockType> bool processBlock (const BlockType&, bool replaceOutput);
+    template <typename SampleType> bool processChunksWithTimeStampedMIDI (const choc::buffer::ChannelArrayView<const SampleType>,
+                                                                          const choc::buffer::ChannelArrayView<SampleType>,
+                                                                          const choc::midi::ShortMessage*, const int*, uint32_t,
+                                                                          const choc::audio::AudioMIDIBlockDispatcher::HandleMIDIMessageFn&,
+                                                                          bool replaceOutput);
+
+    template <typename BlockType>
+    RenderFunctions<BlockType>& getRenderFunctions()
+    {
+        if constexpr (std::is_same<BlockType, Block>::value)
+            return renderFunctions32;
+        else
+            return renderFunctions64;
+    }
+
+    template <typename SampleType>
+    choc::buffer::InterleavingScratchBuffer<SampleType>& getInputScratchBuffer()
+    {
+        if constexpr (std::is_same<SampleType, float>::value)
+            return audioInputScratchBuffer32;
+        else
+            return audioInputScratchBuffer64;
+    }
+
+    template <typename BlockType> void dispatchMIDIOutputEvents (const BlockType&);
     void moveOutputEventsToQueue();
 };
 
@@ -234,9 +308,82 @@ inline AudioMIDIPerformer::Builder::Builder (cmaj::Engine e, uint32_t eventFIFOS
     audioOutputChannelsUsed.resize (countTotalAudioChannels (result->engine.getOutputEndpoints()));
 }
 
-inline void AudioMIDIPerformer::Builder::ensureInputScratchBufferChannelCount (uint32_t channelsNeeded)
+template <typename Fn>
+void AudioMIDIPerformer::Builder::addPreRenderFunction (Fn&& fn)
+{
+    result->renderFunctions32.preRender.push_back (fn);
+    result->renderFunctions64.preRender.push_back (fn);
+}
+
+template <typename Fn>
+void AudioMIDIPerformer::Builder::addPostRenderReplaceFunction (Fn&& fn)
+{
+    result->renderFunctions32.postRenderReplace.push_back (fn);
+    result->renderFunctions64.postRenderReplace.push_back (fn);
+}
+
+template <typename Fn>
+void AudioMIDIPerformer::Builder::addPostRenderAddFunction (Fn&& fn)
 {
-    [[maybe_unused]] auto resized = result->audioInputScratchBuffer.getInterleavedBuffer ({ channelsNeeded, maxFramesPerBlock });
+    result->renderFunctions32.postRenderAdd.push_back (fn);
+    result->renderFunctions64.postRenderAdd.push_back (fn);
+}
+
+template <typename SampleType>
+void AudioMIDIPerformer::Builder::addInputCopyFunction (EndpointHandle endpointHandle,
+                                                        uint32_t numChannelsInEndpoint,
+                                                        const std::vector<uint32_t>& inputChannels,
+                                                        const std::vector<uint32_t>& endpointChannels,
+                                                        std::shared_ptr<AudioDataListener> listener)
+{
+    // The scratch buffer must match the endpoint's sample type, as the performer takes raw frame data
+    [[maybe_unused]] auto resized = result->getInputScratchBuffer<SampleType>().getInterleavedBuffer ({ numChannelsInEndpoint, maxFramesPerBlock });
+
+    auto copyViaScratch = [amp = result.get(), endpointHandle, numChannelsInEndpoint,
+                           endpointChannels, inputChannels, listener]
+                          (const auto& block)
+    {
+        auto numFrames = block.audioInput.getNumFrames();
+        auto interleavedBuffer = amp->getInputScratchBuffer<SampleType>().getInterleavedBuffer ({ numChannelsInEndpoint, numFrames });
+
+        for (uint32_t i = 0; i < inputChannels.size(); i++)
+            copy (interleavedBuffer.getChannel (endpointChannels[i]),
+                    block.audioInput.getChannel (inputChannels[i]));
+
+        if (listener)
+            listener->process (interleavedBuffer);
+
+        amp->performer.setInputFrames (endpointHandle, interleavedBuffer.data.data, numFrames);
+    };
+
+    if (numChannelsInEndpoint == 1 && inputChannels.size() == 1)
+    {
+        // A mono endpoint can read straight from the host's channel when the sample types
+        // match, because a single channel is already laid out like an interleaved stream
+        using DirectBlockType = typename std::conditional<std::is_same<SampleType, float>::value, Block, DoublePrecisionBlock>::type;
+
+        result->getRenderFunctions<DirectBlockType>().preRender.push_back ([amp = result.get(), endpointHandle, listener,
+                                                                            sourceChannel = inputChannels.front()]
+                                                                           (const DirectBlockType& block)
+        {
+            auto source = block.audioInput.getChannel (sourceChannel);
+            auto numFrames = source.getNumFrames();
+
+            if (listener)
+                listener->process (choc::buffer::createInterleavedView (const_cast<SampleType*> (source.data.data), 1u, numFrames));
+
+            amp->performer.setInputFrames (endpointHandle, source.data.data, numFrames);
+        });
+
+        if constexpr (std::is_same<SampleType, float>::value)
+            result->renderFunctions64.preRender.push_back (copyViaScratch);
+        else
+            result->renderFunctions32.preRender.push_back (copyViaScratch);
+    }
+    else
+    {
+        addPreRenderFunction (copyViaScratch);
+    }
 }
 
 inline bool AudioMIDIPerformer::Builder::connectAudioInputTo (const std::vector<uint32_t>& inputChannels,
@@ -248,25 +395,12 @@ inline bool AudioMIDIPerformer::Builder::connectAudioInputTo (const std::vector<
 
     if (auto numChannelsInEndpoint = getNumFloatChannelsInStream (endpoint))
     {
-        ensureInputScratchBufferChannelCount (numChannelsInEndpoint);
         auto endpointHandle = result->engine.getEndpointHandle (endpoint.endpointID);
 
-        result->preRenderFunctions.push_back ([amp = result.get(), endpointHandle, numChannelsInEndpoint,
-                                               endpointChannels, inputChannels, listener]
-                                              (const choc::audio::AudioMIDIBlockDispatcher::Block& block)
-        {
-            auto numFrames = block.audioInput.getNumFrames();
-            auto interleavedBuffer = amp->audioInputScratchBuffer.getInterleavedBuffer ({ numChannelsInEndpoint, numFrames });
-
-            for (uint32_t i = 0; i < inputChannels.size(); i++)
-                copy (interleavedBuffer.getChannel (endpointChannels[i]),
-                        block.audioInput.getChannel (inputChannels[i]));
-
-            if (listener)
-                listener->process (interleavedBuffer);
-
-            amp->performer.setInputFrames (endpointHandle, interleavedBuffer.data.data, numFrames);
-        });
+        if (isFloat32 (endpoint.dataTypes.front()))
+            addInputCopyFunction<float> (endpointHandle, numChannelsInEndpoint, inputChannels, endpointChannels, listener);
+        else
+            addInputCopyFunction<double> (endpointHandle, numChannelsInEndpoint, inputChannels, endpointChannels, listener);
 
         return true;
     }
@@ -284,7 +418,7 @@ inline void AudioMIDIPerformer::Builder::createOutputChannelClearAction()
 
     if (highestUsedChannel == 0)
     {
-        result->postRenderReplaceFunctions.push_back ([] (const choc::audio::AudioMIDIBlockDispatcher::Block& block)
+        addPostRenderReplaceFunction ([] (const auto& block)
         {
             block.audioOutput.clear();
         });
@@ -299,8 +433,7 @@ inline void AudioMIDIPerformer::Builder::createOutputChannelClearAction()
 
         if (channelsToClear.empty())
         {
-            result->postRenderReplaceFunctions.push_back ([highestUsedChannel]
-                                                          (const choc::audio::AudioMIDIBlockDispatcher::Block& block)
+            addPostRenderReplaceFunction ([highestUsedChannel] (const auto& block)
             {
                 auto totalChans = block.audioOutput.getNumChannels();
 
@@ -310,8 +443,7 @@ inline void AudioMIDIPerformer::Builder::createOutputChannelClearAction()
         }
         else
         {
-            result->postRenderReplaceFunctions.push_back ([channelsToClear, highestUsedChannel]
-                                                          (const choc::audio::AudioMIDIBlockDispatcher::Block& block)
+            addPostRenderReplaceFunction ([channelsToClear, highestUsedChannel] (const auto& block)
             {
                 for (auto chan : channelsToClear)
                     block.audioOutput.getChannel (chan).clear();
@@ -341,8 +473,7 @@ void AudioMIDIPerformer::Builder::addOutputCopyFunction (EndpointHandle endpoint
     {
         if (listener)
         {
-            result->postRenderAddFunctions.push_back ([amp = result.get(), endpointHandle, scratch, listener]
-                                                      (const choc::audio::AudioMIDIBlockDispatcher::Block& block)
+            addPostRenderAddFunction ([amp = result.get(), endpointHandle, scratch, listener] (const auto& block)
             {
                 auto destSize = block.audioOutput.getSize();
                 auto source = scratch.getStart (destSize.numFrames);
@@ -351,8 +482,7 @@ void AudioMIDIPerformer::Builder::addOutputCopyFunction (EndpointHandle endpoint
                 listener->process (source);
             });
 
-            result->postRenderReplaceFunctions.push_back ([amp = result.get(), endpointHandle, scratch, listener]
-                                                          (const choc::audio::AudioMIDIBlockDispatcher::Block& block)
+            addPostRenderReplaceFunction ([amp = result.get(), endpointHandle, scratch, listener] (const auto& block)
             {
                 auto destSize = block.audioOutput.getSize();
                 auto source = scratch.getStart (destSize.numFrames);
@@ -393,8 +523,7 @@ void AudioMIDIPerformer::Builder::addOutputCopyFunction (EndpointHandle endpoint
         allMappings.push_back ({ src, dest });
     }
 
-    result->postRenderAddFunctions.push_back ([amp = result.get(), endpointHandle, scratch, allMappings, listener]
-                                              (const choc::audio::AudioMIDIBlockDispatcher::Block& block)
+    addPostRenderAddFunction ([amp = result.get(), endpointHandle, scratch, allMappings, listener] (const auto& block)
     {
         auto destSize = block.audioOutput.getSize();
         auto source = scratch.getStart (destSize.numFrames);
@@ -410,67 +539,92 @@ void AudioMIDIPerformer::Builder::addOutputCopyFunction (EndpointHandle endpoint
             add (dest.getChannel (c.dest), source.getChannel (c.source));
     });
 
-    if (numChannelsInEndpoint == 1 && channelsToAddTo.empty() && (std::is_same<SampleType, float>::value))
+    auto copyViaScratch = [amp = result.get(), endpointHandle, scratch, channelsToOverwrite, channelsToAddTo, listener]
+                          (const auto& block)
     {
-        if (channelsToOverwrite.size() == 1)
-        {
-            result->postRenderReplaceFunctions.push_back ([amp = result.get(), endpointHandle, listener, destChannel = channelsToOverwrite.front().dest]
-                                                          (const choc::audio::AudioMIDIBlockDispatcher::Block& block)
-            {
-                auto dest = block.audioOutput.getChannel (destChannel);
-                amp->performer.copyOutputFrames (endpointHandle, dest.data.data, dest.getNumFrames());
+        auto destSize = block.audioOutput.getSize();
+        auto source = scratch.getStart (destSize.numFrames);
 
-                if (listener)
-                    listener->process (choc::buffer::createInterleavedView (reinterpret_cast<SampleType*> (dest.data.data), 1u, dest.getNumFrames()));
-            });
-        }
-        else
-        {
-            result->postRenderReplaceFunctions.push_back ([amp = result.get(), endpointHandle, listener, channelsToOverwrite]
-                                                          (const choc::audio::AudioMIDIBlockDispatcher::Block& block)
-            {
-                auto firstIndex = channelsToOverwrite.front().dest;
-                auto numOutChans = block.audioOutput.getNumChannels();
+        amp->performer.copyOutputFrames (endpointHandle, source);
 
-                if (firstIndex < numOutChans)
-                {
-                    auto firstChan = block.audioOutput.getChannel (firstIndex);
-                    amp->performer.copyOutputFrames (endpointHandle, firstChan.data.data, firstChan.getNumFrames());
+        if (listener)
+            listener->process (source);
 
-                    if (listener)
-                        listener->process (choc::buffer::createInterleavedView (reinterpret_cast<SampleType*> (firstChan.data.data), 1u, firstChan.getNumFrames()));
+        auto dest = block.audioOutput.getStart (destSize.numFrames);
 
-                    for (size_t i = 1; i < channelsToOverwrite.size(); ++i)
-                    {
-                        auto index = channelsToOverwrite[i].dest;
+        for (auto c : channelsToOverwrite)
+            copy (dest.getChannel (c.dest), source.getChannel (c.source));
 
-                        if (index < numOutChans)
-                            copy (block.audioOutput.getChannel (index), firstChan);
-                    }
-                }
-            });
-        }
+        for (auto c : channelsToAddTo)
+            add (dest.getChannel (c.dest), source.getChannel (c.source));
+    };
+
+    if (numChannelsInEndpoint == 1 && channelsToAddTo.empty())
+    {
+        // A mono endpoint can be rendered straight into the host's buffer when the sample
+        // types match, so only the other precision needs to go via the scratch buffer
+        std::vector<uint32_t> destChannels;
+
+        for (auto& c : channelsToOverwrite)
+            destChannels.push_back (c.dest);
+
+        addDirectOutputCopyFunction<SampleType> (endpointHandle, destChannels, listener);
+
+        if constexpr (std::is_same<SampleType, float>::value)
+            result->renderFunctions64.postRenderReplace.push_back (copyViaScratch);
+        else
+            result->renderFunctions32.postRenderReplace.push_back (copyViaScratch);
     }
     else
     {
-        result->postRenderReplaceFunctions.push_back ([amp = result.get(), endpointHandle, scratch, channelsToOverwrite, channelsToAddTo, listener]
-                                                      (const choc::audio::AudioMIDIBlockDispatcher::Block& block)
-        {
-            auto destSize = block.audioOutput.getSize();
-            auto source = scratch.getStart (destSize.numFrames);
+        addPostRenderReplaceFunction (copyViaScratch);
+    }
+}
 
-            amp->performer.copyOutputFrames (endpointHandle, source);
+template <typename SampleType>
+void AudioMIDIPerformer::Builder::addDirectOutputCopyFunction (EndpointHandle endpointHandle,
+                                                               const std::vector<uint32_t>& destChannels,
+                                                               std::shared_ptr<AudioDataListener> listener)
+{
+    auto& functions = result->getRenderFunctions<typename std::conditional<std::is_same<SampleType, float>::value,
+                                                                           Block, DoublePrecisionBlock>::type>();
+
+    if (destChannels.size() == 1)
+    {
+        functions.postRenderReplace.push_back ([amp = result.get(), endpointHandle, listener, destChannel = destChannels.front()]
+                                               (const auto& block)
+        {
+            auto dest = block.audioOutput.getChannel (destChannel);
+            amp->performer.copyOutputFrames (endpointHandle, dest.data.data, dest.getNumFrames());
 
             if (listener)
-                listener->process (source);
+                listener->process (choc::buffer::createInterleavedView (reinterpret_cast<SampleType*> (dest.data.data), 1u, dest.getNumFrames()));
+        });
+    }
+    else
+    {
+        functions.postRenderReplace.push_back ([amp = result.get(), endpointHandle, listener, destChannels]
+                                               (const auto& block)
+        {
+            auto firstIndex = destChannels.front();
+            auto numOutChans = block.audioOutput.getNumChannels();
 
-            auto dest = block.audioOutput.getStart (destSize.numFrames);
+            if (firstIndex < numOutChans)
+            {
+                auto firstChan = block.audioOutput.getChannel (firstIndex);
+                amp->performer.copyOutputFrames (endpointHandle, firstChan.data.data, firstChan.getNumFrames());
 
-            for (auto c : channelsToOverwrite)
-                copy (dest.getChannel (c.dest), source.getChannel (c.source));
+                if (listener)
+                    listener->process (choc::buffer::createInterleavedView (reinterpret_cast<SampleType*> (firstChan.data.data), 1u, firstChan.getNumFrames()));
 
-            for (auto c : channelsToAddTo)
-                add (dest.getChannel (c.dest), source.getChannel (c.source));
+                for (size_t i = 1; i < destChannels.size(); ++i)
+                {
+                    auto index = destChannels[i];
+
+                    if (index < numOutChans)
+                        copy (block.audioOutput.getChannel (index), firstChan);
+                }
+            }
         });
     }
 }
@@ -696,7 +850,18 @@ inline void AudioMIDIPerformer::playbackStopped()
 }
 
 //==============================================================================
-inline bool AudioMIDIPerformer::process (const choc::audio::AudioMIDIBlockDispatcher::Block& block, bool replaceOutput)
+inline bool AudioMIDIPerformer::process (const Block& block, bool replaceOutput)
+{
+    return processBlock (block, replaceOutput);
+}
+
+inline bool AudioMIDIPerformer::process (const DoublePrecisionBlock& block, bool replaceOutput)
+{
+    return processBlock (block, replaceOutput);
+}
+
+template <typename BlockType>
+bool AudioMIDIPerformer::processBlock (const BlockType& block, bool replaceOutput)
 {
     try
     {
@@ -711,13 +876,13 @@ inline bool AudioMIDIPerformer::process (const choc::audio::AudioMIDIBlockDispat
             {
                 auto numToDo = std::min (currentMaxBlockSize, numFrames - start);
 
-                if (! process ({ block.audioInput.getFrameRange ({ start, start + numToDo }),
-                                 block.audioOutput.getFrameRange ({ start, start + numToDo }),
-                                 start == 0 ? block.midiMessages : choc::span<choc::midi::ShortMessage>(),
-                                 [&] (uint32_t frame, choc::midi::ShortMessage m)
-                                 {
-                                     block.onMidiOutputMessage (start + frame, m);
-                                 }}, replaceOutput))
+                if (! processBlock (BlockType { block.audioInput.getFrameRange ({ start, start + numToDo }),
+                                                block.audioOutput.getFrameRange ({ start, start + numToDo }),
+                                                start == 0 ? block.midiMessages : choc::span<const choc::midi::ShortMessage>(),
+                                                [&] (uint32_t frame, choc::midi::ShortMessage m)
+                                                {
+                                                    block.onMidiOutputMessage (start + frame, m);
+                                                }}, replaceOutput))
                     return false;
 
                 start += numToDo;
@@ -729,7 +894,9 @@ inline bool AudioMIDIPerformer::process (const choc::audio::AudioMIDIBlockDispat
         ++processCallCount;
         performer.setBlockSize (numFrames);
 
-        for (auto& f : preRenderFunctions)
+        auto& functions = getRenderFunctions<BlockType>();
+
+        for (auto& f : functions.preRender)
             f (block);
 
         inputQueue.popAllAvailable ([&] (const void* data, [[maybe_unused]] uint32_t size)
@@ -765,12 +932,12 @@ inline bool AudioMIDIPerformer::process (const choc::audio::AudioMIDIBlockDispat
 
         if (replaceOutput)
         {
-            for (auto& f : postRenderReplaceFunctions)
+            for (auto& f : functions.postRenderReplace)
                 f (block);
         }
         else
         {
-            for (auto& f : postRenderAddFunctions)
+            for (auto& f : functions.postRenderAdd)
                 f (block);
         }
 
@@ -799,8 +966,35 @@ inline bool AudioMIDIPerformer::processWithTimeStampedMIDI (const choc::buffer::
                                                             const choc::audio::AudioMIDIBlockDispatcher::HandleMIDIMessageFn& sendMidiOut,
                                                             bool replaceOutput)
 {
+    return processChunksWithTimeStampedMIDI (audioInput, audioOutput, midiInMessages, midiInMessageTimes,
+                                             totalNumMIDIMessages, sendMidiOut, replaceOutput);
+}
+
+inline bool AudioMIDIPerformer::processWithTimeStampedMIDI (const choc::buffer::ChannelArrayView<const double> audioInput,
+                                                            const choc::buffer::ChannelArrayView<double> audioOutput,
+                                                            const choc::midi::ShortMessage* midiInMessages,
+                                                            const int* midiInMessageTimes,
+                                                            uint32_t totalNumMIDIMessages,
+                                                            const choc::audio::AudioMIDIBlockDispatcher::HandleMIDIMessageFn& sendMidiOut,
+                                                            bool replaceOutput)
+{
+    return processChunksWithTimeStampedMIDI (audioInput, audioOutput, midiInMessages, midiInMessageTimes,
+                                             totalNumMIDIMessages, sendMidiOut, replaceOutput);
+}
+
+template <typename SampleType>
+bool AudioMIDIPerformer::processChunksWithTimeStampedMIDI (const choc::buffer::ChannelArrayView<const SampleType> audioInput,
+                                                           const choc::buffer::ChannelArrayView<SampleType> audioOutput,
+                                                           const choc::midi::ShortMessage* midiInMessages,
+                                                           const int* midiInMessageTimes,
+                                                           uint32_t totalNumMIDIMessages,
+                                                           const choc::audio::AudioMIDIBlockDispatcher::HandleMIDIMessageFn& sendMidiOut,
+                                                           bool replaceOutput)
+{
+    using BlockType = typename std::conditional<std::is_same<SampleType, float>::value, Block, DoublePrecisionBlock>::type;
+
     if (totalNumMIDIMessages == 0)
-        return process (choc::audio::AudioMIDIBlockDispatcher::Block { audioInput, audioOutput, {}, sendMidiOut }, replaceOutput);
+        return processBlock (BlockType { audioInput, audioOutput, {}, sendMidiOut }, replaceOutput);
 
     auto remainingChunk = audioOutput.getFrameRange();
     uint32_t midiStartIndex = 0;
@@ -823,7 +1017,7 @@ inline bool AudioMIDIPerformer::processWithTimeStampedMIDI (const choc::buffer::
             ++endOfMIDI;
         }
 
-        if (! process (choc::audio::AudioMIDIBlockDispatcher::Block {
+        if (! processBlock (BlockType {
                            audioInput.getFrameRange (chunkToDo),
                            audioOutput.getFrameRange (chunkToDo),
                            choc::span<const choc::midi::ShortMessage> (midiInMessages + midiStartIndex,
@@ -842,7 +1036,8 @@ inline bool AudioMIDIPerformer::processWithTimeStampedMIDI (const choc::buffer::
     return false;
 }
 
-inline void AudioMIDIPerformer::dispatchMIDIOutputEvents (const choc::audio::AudioMIDIBlockDispatcher::Block& block)
+template <typename BlockType>
+void AudioMIDIPerformer::dispatchMIDIOutputEvents (const BlockType& block)
 {
     if (! block.onMidiOutputMessage)
         return;
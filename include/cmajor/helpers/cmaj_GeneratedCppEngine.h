@@ -82,6 +82,7 @@ struct GeneratedCppEngine  : public choc::com::ObjectWithAtomicRefCount<EngineIn
                              void*, EngineInterface::RequestExternalFunctionFn) override   { loaded = true; linked = false; return {}; }
     choc::com::String* link (CacheDatabaseInterface*) override                             { loaded = linked = true; return {}; }
     choc::com::String* getLastBuildLog() override                                          { return {}; }
+    choc::com::String* getLastPassTimings() override                                       { return {}; }
 
     PerformerInterface* createPerformer() override
     {
@@ -211,6 +212,9 @@ private:
         uint32_t getXRuns() override            { return xruns; }
         const char* getRuntimeError() override  { return {}; }
 
+        const char* getProfiledNodeNames() override             { return {}; }
+        uint32_t getNodeProfile (uint64_t*, uint32_t) override  { return 0; }
+
         uint32_t getMaximumBlockSize() override { return GeneratedCppClass::maxFramesPerBlock; }
         double getLatency() override            { return GeneratedCppClass::latency; }
         uint32_t getEventBufferSize() override  { return GeneratedCppClass::eventBufferSize; }
@@ -280,6 +280,19 @@ public:
     }
 
     void processBlock (juce::AudioBuffer<float>& audio, juce::MidiBuffer& midi) override
+    {
+        renderBlock (audio, midi);
+    }
+
+    void processBlock (juce::AudioBuffer<double>& audio, juce::MidiBuffer& midi) override
+    {
+        renderBlock (audio, midi);
+    }
+
+    bool supportsDoublePrecisionProcessing() const override    { return true; }
+
+    template <typename SampleType>
+    void renderBlock (juce::AudioBuffer<SampleType>& audio, juce::MidiBuffer& midi)
     {
         if (! patch->isPlayable() || isSuspended())
         {
@@ -308,8 +321,6 @@ public:
                         });
     }
 
-    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override { CMAJ_ASSERT_FALSE; }
-
     //==============================================================================
     void getStateInformation (juce::MemoryBlock& data) override
     {
@@ -0,0 +1,299 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+#pragma once
+
+#include <algorithm>
+#include <optional>
+
+#include "../../choc/text/choc_JSON.h"
+#include "../../choc/text/choc_StringUtilities.h"
+#include "../../choc/text/choc_TextTable.h"
+
+namespace cmaj
+{
+
+//==============================================================================
+/// The measurements made for each compiler pass and transformation when the
+/// BuildSettings::shouldTimePasses() flag is set.
+///
+/// When the flag is set, the engine's getLastPassTimings() returns one of these
+/// objects as JSON. Use fromJSONString() to retrieve it.
+struct PassTimings
+{
+    struct Pass
+    {
+        std::string name;
+        uint64_t runs = 0, changes = 0, objectsAllocated = 0, bytesAllocated = 0;
+        double seconds = 0;
+    };
+
+    /// The passes, in the order in which they first ran
+    std::vector<Pass> passes;
+
+    /// The total number and size of AST objects that had been allocated
+    /// by the end of the build
+    uint64_t totalObjects = 0, totalBytes = 0;
+
+    struct ObjectClass
+    {
+        std::string name;
+        uint64_t numAllocated = 0, bytesAllocated = 0, numLive = 0, bytesLive = 0;
+    };
+
+    /// For each class of AST object, the number that had been allocated before code
+    /// generation started, and how many of those were still reachable from the program.
+    /// The difference is memory that is held by the program's allocator but no longer used.
+    std::vector<ObjectClass> objectClasses;
+
+    bool empty() const      { return passes.empty(); }
+
+    Pass& getPass (std::string_view name)
+    {
+        for (auto& p : passes)
+            if (p.name == name)
+                return p;
+
+        passes.push_back ({});
+        passes.back().name = std::string (name);
+        return passes.back();
+    }
+
+    ObjectClass& getObjectClass (std::string_view name)
+    {
+        for (auto& c : objectClasses)
+            if (c.name == name)
+                return c;
+
+        objectClasses.push_back ({});
+        objectClasses.back().name = std::string (name);
+        return objectClasses.back();
+    }
+
+    void merge (const PassTimings& other)
+    {
+        for (auto& p : other.passes)
+        {
+            auto& dest = getPass (p.name);
+            dest.runs             += p.runs;
+            dest.changes          += p.changes;
+            dest.objectsAllocated += p.objectsAllocated;
+            dest.bytesAllocated   += p.bytesAllocated;
+            dest.seconds          += p.seconds;
+        }
+
+        for (auto& c : other.objectClasses)
+        {
+            auto& dest = getObjectClass (c.name);
+            dest.numAllocated   += c.numAllocated;
+            dest.bytesAllocated += c.bytesAllocated;
+            dest.numLive        += c.numLive;
+            dest.bytesLive      += c.bytesLive;
+        }
+
+        totalObjects += other.totalObjects;
+        totalBytes   += other.totalBytes;
+    }
+
+    double getTotalSeconds() const
+    {
+        double total = 0;
+
+        for (auto& p : passes)
+            total += p.seconds;
+
+        return total;
+    }
+
+    //==============================================================================
+    choc::value::Value toJSON() const
+    {
+        auto list = choc::value::createEmptyArray();
+
+        for (auto& p : passes)
+            list.addArrayElement (choc::value::createObject ({},
+                                                             "name",             p.name,
+                                                             "runs",             static_cast<int64_t> (p.runs),
+                                                             "seconds",          p.seconds,
+                                                             "changes",          static_cast<int64_t> (p.changes),
+                                                             "objectsAllocated", static_cast<int64_t> (p.objectsAllocated),
+                                                             "bytesAllocated",   static_cast<int64_t> (p.bytesAllocated)));
+
+        auto classes = choc::value::createEmptyArray();
+
+        for (auto& c : objectClasses)
+            classes.addArrayElement (choc::value::createObject ({},
+                                                                "name",           c.name,
+                                                                "numAllocated",   static_cast<int64_t> (c.numAllocated),
+                                                                "bytesAllocated", static_cast<int64_t> (c.bytesAllocated),
+                                                                "numLive",        static_cast<int64_t> (c.numLive),
+                                                                "bytesLive",      static_cast<int64_t> (c.bytesLive)));
+
+        return choc::value::createObject ({},
+                                          "passes",        list,
+                                          "objectClasses", classes,
+                                          "totalObjects",  static_cast<int64_t> (totalObjects),
+                                          "totalBytes",    static_cast<int64_t> (totalBytes));
+    }
+
+    static PassTimings fromJSON (const choc::value::ValueView& v)
+    {
+        PassTimings result;
+
+        auto getInt = [] (const choc::value::ValueView& o, const char* name) -> uint64_t
+        {
+            return static_cast<uint64_t> (o[name].getWithDefault<int64_t> (0));
+        };
+
+        if (v.isObject())
+        {
+            if (v.hasObjectMember ("passes") && v["passes"].isArray())
+            {
+                for (auto p : v["passes"])
+                {
+                    auto& pass = result.getPass (p["name"].getWithDefault<std::string> ({}));
+                    pass.runs             = getInt (p, "runs");
+                    pass.changes          = getInt (p, "changes");
+                    pass.objectsAllocated = getInt (p, "objectsAllocated");
+                    pass.bytesAllocated   = getInt (p, "bytesAllocated");
+                    pass.seconds          = p["seconds"].getWithDefault<double> (0);
+                }
+            }
+
+            if (v.hasObjectMember ("objectClasses") && v["objectClasses"].isArray())
+            {
+                for (auto c : v["objectClasses"])
+                {
+                    auto& objectClass = result.getObjectClass (c["name"].getWithDefault<std::string> ({}));
+                    objectClass.numAllocated   = getInt (c, "numAllocated");
+                    objectClass.bytesAllocated = getInt (c, "bytesAllocated");
+                    objectClass.numLive        = getInt (c, "numLive");
+                    objectClass.bytesLive      = getInt (c, "bytesLive");
+                }
+            }
+
+            result.totalObjects = getInt (v, "totalObjects");
+            result.totalBytes   = getInt (v, "totalBytes");
+        }
+
+        return result;
+    }
+
+    /// Parses the string returned by an engine's getLastPassTimings() method, which
+    /// will be empty if the timePasses build setting wasn't enabled.
+    static std::optional<PassTimings> fromJSONString (std::string_view json)
+    {
+        if (json.empty())
+            return {};
+
+        try
+        {
+            auto v = choc::json::parse (json);
+
+            if (v.isObject())
+                return fromJSON (v);
+        }
+        catch (const std::exception&) {}
+
+        return {};
+    }
+
+    //==============================================================================
+    /// Returns a human-readable table of the passes, with the slowest first.
+    std::string toTable() const
+    {
+        auto sorted = passes;
+
+        std::stable_sort (sorted.begin(), sorted.end(), [] (const Pass& a, const Pass& b)
+        {
+            return a.seconds > b.seconds;
+        });
+
+        auto totalSeconds = getTotalSeconds();
+
+        choc::text::TextTable table;
+        table << "Pass" << "Runs" << "Time" << "%" << "Changes" << "Objects" << "Allocated";
+        table.newRow();
+
+        for (auto& p : sorted)
+        {
+            auto percentage = totalSeconds > 0 ? (100.0 * p.seconds / totalSeconds) : 0.0;
+
+            table << p.name
+                  << std::to_string (p.runs)
+                  << choc::text::getDurationDescription (std::chrono::duration<double> (p.seconds))
+                  << std::to_string (static_cast<int> (percentage + 0.5)) + "%"
+                  << std::to_string (p.changes)
+                  << std::to_string (p.objectsAllocated)
+                  << choc::text::getByteSizeDescription (p.bytesAllocated);
+            table.newRow();
+        }
+
+        return table.toString ({}, "  ", "\n")
+                + "\nTotal: " + choc::text::getDurationDescription (std::chrono::duration<double> (totalSeconds))
+                + ", AST objects: " + std::to_string (totalObjects)
+                + " (" + choc::text::getByteSizeDescription (totalBytes) + ")\n"
+                + getObjectClassTable();
+    }
+
+    /// Returns a human-readable table of the classes of AST object that use the
+    /// most memory, or an empty string if there's no information about them.
+    std::string getObjectClassTable (size_t maxNumClasses = 20) const
+    {
+        if (objectClasses.empty())
+            return {};
+
+        auto sorted = objectClasses;
+
+        std::stable_sort (sorted.begin(), sorted.end(), [] (const ObjectClass& a, const ObjectClass& b)
+        {
+            return a.bytesAllocated > b.bytesAllocated;
+        });
+
+        if (sorted.size() > maxNumClasses)
+            sorted.resize (maxNumClasses);
+
+        uint64_t allocated = 0, live = 0;
+
+        for (auto& c : objectClasses)
+        {
+            allocated += c.bytesAllocated;
+            live += c.bytesLive;
+        }
+
+        choc::text::TextTable table;
+        table << "AST class" << "Allocated" << "Live" << "Memory" << "Live memory";
+        table.newRow();
+
+        for (auto& c : sorted)
+        {
+            table << c.name
+                  << std::to_string (c.numAllocated)
+                  << std::to_string (c.numLive)
+                  << choc::text::getByteSizeDescription (c.bytesAllocated)
+                  << choc::text::getByteSizeDescription (c.bytesLive);
+            table.newRow();
+        }
+
+        return "\n" + table.toString ({}, "  ", "\n")
+                + "\nAST objects still in use before code generation: " + choc::text::getByteSizeDescription (live)
+                + " of " + choc::text::getByteSizeDescription (allocated) + "\n";
+    }
+};
+
+} // namespace cmaj
@@ -20,7 +20,9 @@
 
 #include "cmaj_PatchHelpers.h"
 #include "cmaj_AudioMIDIPerformer.h"
+#include "cmaj_RealtimeHandOver.h"
 
+#include <array>
 #include <mutex>
 #include <unordered_map>
 #include <unordered_set>
@@ -164,10 +166,14 @@ struct Patch
     //==============================================================================
     /// Processes the next block, optionally adding or replacing the audio output data
     void process (const choc::audio::AudioMIDIBlockDispatcher::Block&, bool replaceOutput);
+    /// Processes the next block of double-precision audio
+    void process (const AudioMIDIPerformer::DoublePrecisionBlock&, bool replaceOutput);
 
     /// Renders a block using a juce-style single array of input + output audio channels.
     /// For this one, make calls to addMIDIMessage() beforehand to provide the MIDI.
     void process (float* const* audioChannels, uint32_t numFrames, const choc::audio::AudioMIDIBlockDispatcher::HandleMIDIMessageFn&);
+    /// A double-precision version of the juce-style process() method
+    void process (double* const* audioChannels, uint32_t numFrames, const choc::audio::AudioMIDIBlockDispatcher::HandleMIDIMessageFn&);
 
     /// Instead of calling process(), if you're performing multiple small chunked render ops
     /// as part of a larger chunk, you can improve performance by calling beginChunkedProcess(),
@@ -177,6 +183,8 @@ struct Patch
     /// has been called, but may be called multiple times. After all chunks are done, call
     /// endChunkedProcess() to finish.
     void processChunk (const choc::audio::AudioMIDIBlockDispatcher::Block&, bool replaceOutput);
+    /// A double-precision version of processChunk()
+    void processChunk (const AudioMIDIPerformer::DoublePrecisionBlock&, bool replaceOutput);
     /// Called after beginChunkedProcess() and processChunk() have been used, to clear up
     /// after a sequence of chunks have been rendered.
     void endChunkedProcess();
@@ -243,7 +251,7 @@ struct Patch
     void sendPatchStatusChangeToViews() const;
     void sendParameterChangeToViews (const EndpointID&, float value) const;
     void sendCurrentParameterValueToViews (const EndpointID&) const;
-    void sendCPUInfoToViews (float level) const;
+    void sendCPUInfoToViews (float level, const choc::value::ValueView& nodeLevels = {}) const;
     void sendStoredStateValueToViews (const std::string& key) const;
 
     // These can be called by things like the GUI to control the patch
@@ -263,6 +271,12 @@ struct Patch
     /// Sets the number of frames processed per CPU usage message
     void setCPUInfoMonitorChunkSize (uint32_t);
 
+    /// If this is set, it will be called on the message thread with each CPU usage message
+    /// that is sent to the views. If the engine was built with BuildSettings::setProfileNodes()
+    /// enabled, the message will contain a "nodes" array, with the level for each graph node,
+    /// sorted with the most expensive first.
+    std::function<void(const choc::value::ValueView&)> handleCPUInfo;
+
     /// Starts sending data messages to clients for a particular endpoint.
     /// The replyType is the type ID to use for the events that are sent to the client.
     /// For audio endpoints, granularity == 1 sends complete blocks of all incoming data
@@ -333,6 +347,14 @@ private:
     bool scanFilesForChanges = false;
     LoadParams lastLoadParams;
     std::shared_ptr<PatchRenderer> renderer;
+
+    // The renderer is handed to the audio thread without locking, so that a rebuilt patch
+    // can be swapped in without stopping playback. Replaced renderers are released by a
+    // background thread once the audio thread has stopped using them.
+    RealtimeHandOver<PatchRenderer> rendererForAudioThread;
+    PatchRenderer* audioThreadRenderer = nullptr;
+    std::atomic<bool> playable { false };
+    choc::threading::TaskThread retiredObjectReleaseThread;
     PlaybackParams currentPlaybackParams;
     std::string hostDescription;
     std::unordered_map<std::string, CustomAudioSourcePtr> customAudioInputSources;
@@ -354,6 +376,8 @@ private:
 
     void sendPatchChange();
     void setNewRenderer (std::shared_ptr<PatchRenderer>);
+    void releaseRetiredObjects();
+    template <typename Fn> bool withAudioThreadRenderer (Fn&&);
     void sendOutputEventToViews (uint64_t frame, std::string_view endpointID, const choc::value::ValueView&);
     PatchView* findViewForID (uint16_t) const;
     void startCheckingForChanges();
@@ -445,9 +469,11 @@ struct Patch::ClientEventQueue
         clientEventHandlerThread.stop();
     }
 
-    void prepare (double sampleRate)
+    void prepare (double newSampleRate)
     {
+        sampleRate = newSampleRate;
         cpu.reset (sampleRate);
+        lastNodeProfile.clear();
         fifo.reset (patch.clientEventQueueSize);
         dispatchClientEventsCallback = [this] { dispatchClientEvents(); };
         clientEventHandlerThread.start (0, [this]
@@ -481,23 +507,68 @@ struct Patch::ClientEventQueue
 
     void postCPULevel (float level)
     {
-        fifo.push (1 + sizeof (float), [&] (void* dest)
+        uint32_t numNodes = 0;
+
+        if (performerForNodeProfile != nullptr)
+            numNodes = performerForNodeProfile->performer.getNodeProfile (nodeProfile.data(), maxProfiledNodes);
+
+        fifo.push (1 + sizeof (float) + sizeof (uint64_t) + numNodes * sizeof (uint64_t), [&] (void* dest)
         {
             auto d = static_cast<char*> (dest);
             d[0] = static_cast<char> (EventType::cpuLevel);
             choc::memory::writeNativeEndian (d + 1, level);
+            choc::memory::writeNativeEndian (d + 5, totalFramesProcessed);
+            memcpy (d + 13, nodeProfile.data(), numNodes * sizeof (uint64_t));
         });
 
         triggerDispatchOnEndOfBlock = true;
     }
 
-    void dispatchCPULevel (const char* d)
+    void dispatchCPULevel (const char* d, uint32_t size)
     {
         auto value = choc::memory::readNativeEndian<float> (d + 1);
-        patch.sendCPUInfoToViews (value);
+        auto numNodes = (size - 13) / sizeof (uint64_t);
+
+        if (numNodes == 0)
+            return patch.sendCPUInfoToViews (value);
+
+        auto frame = choc::memory::readNativeEndian<uint64_t> (d + 5);
+        std::vector<uint64_t> newProfile (numNodes);
+        memcpy (newProfile.data(), d + 13, numNodes * sizeof (uint64_t));
+
+        std::vector<std::string> names;
+
+        if (patch.renderer != nullptr)
+            if (auto p = patch.renderer->getPerformerPointer())
+                names = p->performer.getProfiledNodeNames();
+
+        auto nodeLevels = choc::value::createEmptyArray();
+
+        if (names.size() >= numNodes && lastNodeProfile.size() == numNodes && frame > lastNodeProfileFrame)
+        {
+            auto nanosecondsElapsed = 1.0e9 * static_cast<double> (frame - lastNodeProfileFrame) / sampleRate;
+            std::vector<std::pair<std::string, double>> levels;
+
+            for (size_t i = 0; i < numNodes; ++i)
+            {
+                // if the performer has been reset, its totals will have started again from zero
+                auto elapsed = newProfile[i] >= lastNodeProfile[i] ? newProfile[i] - lastNodeProfile[i] : newProfile[i];
+                levels.push_back ({ names[i], static_cast<double> (elapsed) / nanosecondsElapsed });
+            }
+
+            std::stable_sort (levels.begin(), levels.end(), [] (auto& a, auto& b) { return a.second > b.second; });
+
+            for (auto& l : levels)
+                nodeLevels.addArrayElement (choc::json::create ("name", l.first,
+                                                                "level", static_cast<float> (l.second)));
+        }
+
+        lastNodeProfile = std::move (newProfile);
+        lastNodeProfileFrame = frame;
+        patch.sendCPUInfoToViews (value, nodeLevels);
     }
 
-    void postAudioMinMax (const PatchView& view, const std::string& eventName, const choc::buffer::ChannelArrayBuffer<float>& levels)
+    void postAudioMinMax (uint16_t viewID, const std::string& eventName, const choc::buffer::ChannelArrayBuffer<float>& levels)
     {
         triggerDispatchOnEndOfBlock = true;
         auto numChannels = levels.getNumChannels();
@@ -509,7 +580,7 @@ struct Patch::ClientEventQueue
         {
             auto d = static_cast<char*> (dest);
             *d++ = static_cast<char> (EventType::audioMinMaxLevels);
-            choc::memory::writeNativeEndian<uint16_t> (d, view.viewID);
+            choc::memory::writeNativeEndian<uint16_t> (d, viewID);
             d += sizeof (uint16_t);
             choc::memory::writeNativeEndian<uint16_t> (d, static_cast<uint16_t> (numChannels));
             d += sizeof (uint16_t);
@@ -557,7 +628,7 @@ struct Patch::ClientEventQueue
         }
     }
 
-    void postAudioFullData (const PatchView& view, const std::string& eventName, const choc::buffer::ChannelArrayBuffer<float>& levels)
+    void postAudioFullData (uint16_t viewID, const std::string& eventName, const choc::buffer::ChannelArrayBuffer<float>& levels)
     {
         triggerDispatchOnEndOfBlock = true;
         auto numChannels = levels.getNumChannels();
@@ -571,7 +642,7 @@ struct Patch::ClientEventQueue
         {
             auto d = static_cast<char*> (dest);
             *d++ = static_cast<char> (EventType::audioFullData);
-            choc::memory::writeNativeEndian<uint16_t> (d, view.viewID);
+            choc::memory::writeNativeEndian<uint16_t> (d, viewID);
             d += sizeof (uint16_t);
             *d++ = static_cast<char> (numChannels);
             choc::memory::writeNativeEndian<uint16_t> (d, static_cast<uint16_t> (numFrames));
@@ -622,11 +693,10 @@ struct Patch::ClientEventQueue
         }
     }
 
-    void postEndpointEvent (const PatchView& view, const std::string& eventName, const void* messageData, uint32_t messageSize)
+    void postEndpointEvent (uint16_t viewID, const std::string& eventName, const void* messageData, uint32_t messageSize)
     {
         auto eventNameChars = eventName.data();
         auto eventNameLen = static_cast<uint32_t> (eventName.length());
-        auto viewID = view.viewID;
 
         fifo.push (4 + eventNameLen + messageSize, [=] (void* dest)
         {
@@ -641,16 +711,16 @@ struct Patch::ClientEventQueue
         triggerDispatchOnEndOfBlock = true;
     }
 
-    void postEndpointEvent (const PatchView& view, const std::string& eventName, const choc::value::ValueView& message)
+    void postEndpointEvent (uint16_t viewID, const std::string& eventName, const choc::value::ValueView& message)
     {
         auto serialisedMessage = message.serialise();
-        postEndpointEvent (view, eventName, serialisedMessage.data.data(), static_cast<uint32_t> (serialisedMessage.data.size()));
+        postEndpointEvent (viewID, eventName, serialisedMessage.data.data(), static_cast<uint32_t> (serialisedMessage.data.size()));
     }
 
-    void postEndpointMIDI (const PatchView& view, const std::string& eventName, choc::midi::ShortMessage message)
+    void postEndpointMIDI (uint16_t viewID, const std::string& eventName, choc::midi::ShortMessage message)
     {
         auto data = serialisedMIDIMessage.getSerialisedData (message);
-        postEndpointEvent (view, eventName, data.data, data.size);
+        postEndpointEvent (viewID, eventName, data.data, data.size);
     }
 
     void dispatchEndpointEvent (const char* d, uint32_t size)
@@ -675,14 +745,18 @@ struct Patch::ClientEventQueue
         framesProcessedInBlock = 0;
     }
 
-    void postProcessChunk (const choc::audio::AudioMIDIBlockDispatcher::Block& block)
+    template <typename BlockType>
+    void postProcessChunk (const BlockType& block)
     {
         framesProcessedInBlock += block.audioOutput.getNumFrames();
     }
 
-    void endOfProcessCallback()
+    void endOfProcessCallback (AudioMIDIPerformer* performer)
     {
+        totalFramesProcessed += framesProcessedInBlock;
+        performerForNodeProfile = performer;
         cpu.endProcess (framesProcessedInBlock);
+        performerForNodeProfile = nullptr;
 
         if (triggerDispatchOnEndOfBlock)
         {
@@ -703,7 +777,7 @@ struct Patch::ClientEventQueue
                 case EventType::audioMinMaxLevels:      dispatchAudioMinMax (d, d + size); break;
                 case EventType::audioFullData:          dispatchAudioFullData (d, d + size); break;
                 case EventType::endpointEvent:          dispatchEndpointEvent (d, size); break;
-                case EventType::cpuLevel:               dispatchCPULevel (d); break;
+                case EventType::cpuLevel:               dispatchCPULevel (d, size); break;
                 default:                                break;
             }
         });
@@ -725,8 +799,19 @@ struct Patch::ClientEventQueue
     MIDIEvents::SerialisedShortMIDIMessage serialisedMIDIMessage;
     bool triggerDispatchOnEndOfBlock = false;
     uint32_t framesProcessedInBlock = 0;
+    uint64_t totalFramesProcessed = 0;
+    double sampleRate = 44100.0;
 
     CPUMonitor cpu;
+
+    // Used on the audio thread to read the performer's node profile when a CPU level is posted
+    static constexpr uint32_t maxProfiledNodes = 256;
+    std::array<uint64_t, maxProfiledNodes> nodeProfile;
+    AudioMIDIPerformer* performerForNodeProfile = nullptr;
+
+    // Used on the message thread to turn the totals into levels
+    std::vector<uint64_t> lastNodeProfile;
+    uint64_t lastNodeProfileFrame = 0;
 };
 
 //==============================================================================
@@ -796,9 +881,10 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
 
     ~PatchRenderer()
     {
-        patchWorker.reset();
-        infiniteLoopCheckTimer.clear();
+        stopMessageThreadTasks();
         handleOutputEvent.reset();
+        delete pendingPerformer.exchange (nullptr);
+        delete performerToDelete.exchange (nullptr);
     }
 
     bool isPlayable() const     { return performer != nullptr; }
@@ -819,6 +905,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
     {
         AudioLevelMonitor (PatchView& v, const EndpointDetails& endpoint, std::string type, uint32_t gran, bool fullData)
             : view (v),
+              viewID (v.viewID),
               endpointID (endpoint.endpointID.toString()),
               replyType (std::move (type)),
               sendFullData (fullData),
@@ -872,7 +959,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
                 if (++frameCount == granularity)
                 {
                     frameCount = 0;
-                    queue.postAudioMinMax (view, replyType, levels);
+                    queue.postAudioMinMax (viewID, replyType, levels);
                 }
             }
         }
@@ -895,7 +982,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
                 if (frameCount == granularity)
                 {
                     frameCount = 0;
-                    queue.postAudioFullData (view, replyType, levels);
+                    queue.postAudioFullData (viewID, replyType, levels);
                     break;
                 }
 
@@ -909,7 +996,10 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
             return std::addressof (view) == std::addressof (v) && replyType == type && endpointID == e.toString();
         }
 
+        // The audio thread may still be using a monitor for a short time after it has been
+        // removed, so it only uses the viewID, never the view itself
         PatchView& view;
+        const uint16_t viewID;
         const std::string endpointID, replyType;
         const bool sendFullData;
         const uint32_t granularity;
@@ -939,54 +1029,73 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
     //==============================================================================
     struct DataListener  : public AudioMIDIPerformer::AudioDataListener
     {
-        DataListener (ClientEventQueue& c) : queue (c) {}
+        DataListener (ClientEventQueue& c) : queue (c)
+        {
+            state.set (std::make_shared<State>());
+        }
+
+        void process (const choc::buffer::InterleavedView<float>& block) override   { processBlock (block); }
+        void process (const choc::buffer::InterleavedView<double>& block) override  { processBlock (block); }
 
-        void process (const choc::buffer::InterleavedView<float>& block) override
+        template <typename SampleType>
+        void processBlock (const choc::buffer::InterleavedView<SampleType>& block)
         {
-            if (customSource != nullptr)
-                customSource->read (block);
+            RealtimeHandOver<State>::ScopedAccess s (state);
 
-            for (auto& m : audioMonitors)
+            if (s->customSource != nullptr)
+                s->customSource->read (block);
+
+            for (auto& m : s->audioMonitors)
                 m->process (queue, block);
         }
 
-        void process (const choc::buffer::InterleavedView<double>& block) override
+        void setCustomSource (CustomAudioSourcePtr source)
         {
-            if (customSource != nullptr)
-                customSource->read (block);
+            state.update ([&] (State& newState) { newState.customSource = std::move (source); });
+        }
 
-            for (auto& m : audioMonitors)
-                m->process (queue, block);
+        void addMonitor (std::shared_ptr<AudioLevelMonitor> monitor)
+        {
+            state.update ([&] (State& newState) { newState.audioMonitors.push_back (std::move (monitor)); });
         }
 
         bool removeMonitor (PatchView& view, const EndpointID& e, const std::string& type)
         {
-            auto oldEnd = audioMonitors.end();
-            auto newEnd = std::remove_if (audioMonitors.begin(), oldEnd,
-                                          [&] (auto& m) { return m->isFor (view, e, type); });
-
-            if (newEnd != oldEnd)
-            {
-                audioMonitors.erase (newEnd, oldEnd);
-                return true;
-            }
-
-            return false;
+            return removeMonitorsIf ([&] (auto& m) { return m->isFor (view, e, type); });
         }
 
         void removeMonitorsForView (PatchView& view)
         {
-            auto oldEnd = audioMonitors.end();
-            auto newEnd = std::remove_if (audioMonitors.begin(), oldEnd,
-                                          [&] (auto& m) { return std::addressof (m->view) == std::addressof (view); });
+            removeMonitorsIf ([&] (auto& m) { return std::addressof (m->view) == std::addressof (view); });
+        }
+
+        template <typename Predicate>
+        bool removeMonitorsIf (Predicate&& shouldRemove)
+        {
+            auto current = state.get();
 
-            if (newEnd != oldEnd)
-                audioMonitors.erase (newEnd, oldEnd);
+            if (std::none_of (current->audioMonitors.begin(), current->audioMonitors.end(), shouldRemove))
+                return false;
+
+            state.update ([&] (State& newState)
+            {
+                auto& monitors = newState.audioMonitors;
+                monitors.erase (std::remove_if (monitors.begin(), monitors.end(), shouldRemove), monitors.end());
+            });
+
+            return true;
         }
 
+        // The audio thread only ever reads an immutable snapshot of this state, and changes
+        // are made by publishing a modified copy, so it never has to wait for the message thread.
+        struct State
+        {
+            CustomAudioSourcePtr customSource;
+            std::vector<std::shared_ptr<AudioLevelMonitor>> audioMonitors;
+        };
+
         ClientEventQueue& queue;
-        CustomAudioSourcePtr customSource;
-        std::vector<std::unique_ptr<AudioLevelMonitor>> audioMonitors;
+        RealtimeHandOver<State> state;
     };
 
     //==============================================================================
@@ -1004,7 +1113,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
             configuredPlaybackParams = playbackParams;
             manifest = std::move (loadParams.manifest);
 
-            if (! loadProgram (engine, playbackParams, shouldResolveExternals, checkForStopSignal))
+            if (! loadProgram (engine, playbackParams, shouldResolveExternals, c, checkForStopSignal))
                 return;
 
             if (! shouldResolveExternals)
@@ -1045,11 +1154,12 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
     bool loadProgram (cmaj::Engine& engine,
                       const PlaybackParams& playbackParams,
                       bool shouldResolveExternals,
+                      const cmaj::CacheDatabaseInterface::Ptr& cache,
                       const std::function<void()>& checkForStopSignal)
     {
         cmaj::Program program;
 
-        if (! manifest.addSourceFilesToProgram (program, errors, checkForStopSignal))
+        if (! manifest.addSourceFilesToProgram (program, errors, checkForStopSignal, cache.get()))
             return false;
 
         engine.setBuildSettings (engine.getBuildSettings()
@@ -1197,8 +1307,8 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
 
         if (auto s = patch.getCustomAudioSourceForInput (endpointID))
         {
-            l->customSource = s;
             s->prepare (sampleRate);
+            l->setCustomSource (s);
         }
 
         endpointListeners.add (endpointID, l);
@@ -1225,8 +1335,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
             if (source != nullptr)
                 source->prepare (sampleRate);
 
-            std::scoped_lock lock (processLock);
-            l->customSource = source;
+            l->setCustomSource (std::move (source));
             return true;
         }
 
@@ -1239,19 +1348,13 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
         {
             if (auto l = endpointListeners.findAudioDataListener (e))
             {
-                auto monitor = std::make_unique<AudioLevelMonitor> (view, *details, std::move (replyType), granularity, fullData);
-
-                std::scoped_lock lock (processLock);
-                l->audioMonitors.push_back (std::move (monitor));
+                l->addMonitor (std::make_shared<AudioLevelMonitor> (view, *details, std::move (replyType), granularity, fullData));
                 return true;
             }
 
             if (details->isEvent())
             {
-                auto monitor = std::make_unique<EndpointListeners::EventMonitor> (view, *details, std::move (replyType));
-
-                std::scoped_lock lock (processLock);
-                endpointListeners.add (std::move (monitor));
+                endpointListeners.add (std::make_shared<EndpointListeners::EventMonitor> (view, *details, std::move (replyType)));
                 return true;
             }
         }
@@ -1261,7 +1364,6 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
 
     bool stopEndpointData (PatchView& view, const EndpointID& e, std::string replyType)
     {
-        std::scoped_lock lock (processLock);
         return endpointListeners.remove (view, e, replyType);
     }
 
@@ -1334,8 +1436,10 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
                                            timeoutMilliseconds))
             return false;
 
-        for (auto& m : endpointListeners.eventMonitors)
-            m->process (queue, endpointID.toString(), value);
+        endpointListeners.forEachEventMonitor ([&] (EndpointListeners::EventMonitor& m)
+        {
+            m.process (queue, endpointID.toString(), value);
+        });
 
         return true;
     }
@@ -1348,8 +1452,10 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
         if (! performer->postEvent (endpointID, value, timeoutMilliseconds))
             return false;
 
-        for (auto& m : endpointListeners.eventMonitors)
-            m->process (queue, endpointID.toString(), value);
+        endpointListeners.forEachEventMonitor ([&] (EndpointListeners::EventMonitor& m)
+        {
+            m.process (queue, endpointID.toString(), value);
+        });
 
         return true;
     }
@@ -1376,17 +1482,41 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
         auto newPerformer = performer->engine.createPerformer();
         CMAJ_ASSERT (newPerformer);
 
-        {
-            std::scoped_lock lock (processLock);
-            std::swap (performer->performer, newPerformer);
-        }
+        // The audio thread swaps this in at the start of its next block, and hands back
+        // the old performer so that it can be deleted here rather than on that thread.
+        delete performerToDelete.exchange (nullptr);
+        delete pendingPerformer.exchange (new cmaj::Performer (std::move (newPerformer)));
 
         for (auto& param : parameterList)
             param->resetToDefaultValue (true, -1, 0);
     }
 
-    void beginProcessBlock()    { processLock.lock(); }
-    void endProcessBlock()      { processLock.unlock(); }
+    void beginProcessBlock()
+    {
+        if (performerToDelete.load() == nullptr)
+        {
+            if (auto newPerformer = pendingPerformer.exchange (nullptr))
+            {
+                std::swap (performer->performer, *newPerformer);
+                performerToDelete.store (newPerformer);
+            }
+        }
+    }
+
+    void releaseRetiredObjects()
+    {
+        delete performerToDelete.exchange (nullptr);
+        endpointListeners.releaseRetiredObjects();
+    }
+
+    // Stops any activity that belongs to the message thread. This is called when the renderer
+    // is replaced, because the audio thread may continue to use it for a short time afterwards,
+    // and it may finally be deleted on a background thread.
+    void stopMessageThreadTasks()
+    {
+        patchWorker.reset();
+        infiniteLoopCheckTimer.clear();
+    }
 
     //==============================================================================
     bool postParameterChange (const PatchParameterProperties& properties, EndpointHandle endpointHandle,
@@ -1413,18 +1543,25 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
     //==============================================================================
     void processMIDIMessage (choc::midi::ShortMessage message)
     {
-        for (auto& monitor : endpointListeners.eventMonitors)
-            if (monitor->isMIDI)
-                monitor->process (*patch.clientEventQueue, monitor->endpointID, message);
+        endpointListeners.forEachEventMonitor ([&] (EndpointListeners::EventMonitor& monitor)
+        {
+            if (monitor.isMIDI)
+                monitor.process (*patch.clientEventQueue, monitor.endpointID, message);
+        });
     }
 
-    void processMIDIBlock (const choc::audio::AudioMIDIBlockDispatcher::Block& block)
+    template <typename BlockType>
+    void processMIDIBlock (const BlockType& block)
     {
         if (! block.midiMessages.empty())
-            for (auto& monitor : endpointListeners.eventMonitors)
-                if (monitor->isMIDI)
+        {
+            endpointListeners.forEachEventMonitor ([&] (EndpointListeners::EventMonitor& monitor)
+            {
+                if (monitor.isMIDI)
                     for (auto& m : block.midiMessages)
-                        monitor->process (*patch.clientEventQueue, monitor->endpointID, m);
+                        monitor.process (*patch.clientEventQueue, monitor.endpointID, m);
+            });
+        }
     }
 
     //==============================================================================
@@ -1440,21 +1577,34 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
 
     void sendOutputEventMessages()
     {
-        performer->handlePendingOutputEvents ([this] (uint64_t frame, std::string_view endpointID, const choc::value::ValueView& value)
+        struct PendingEvent
+        {
+            uint64_t frame;
+            std::string endpointID;
+            choc::value::Value value;
+        };
+
+        // Everything that's waiting is converted on this thread, and then handed
+        // to the message thread in a single batch rather than as one message per event
+        std::vector<PendingEvent> events;
+
+        performer->handlePendingOutputEvents ([&] (uint64_t frame, std::string_view endpointID, const choc::value::ValueView& value)
+        {
+            events.push_back ({ frame, std::string (endpointID), addTypeToValueAsProperty (value) });
+        });
+
+        if (! events.empty())
         {
-            choc::messageloop::postMessage ([handler = handleOutputEvent,
-                                             frame,
-                                             endpointID = std::string (endpointID),
-                                             value = addTypeToValueAsProperty (value)]
+            choc::messageloop::postMessage ([handler = handleOutputEvent, events = std::move (events)]
                                             {
-                                                handler (frame, endpointID, value);
+                                                for (auto& e : events)
+                                                    handler (e.frame, e.endpointID, e.value);
                                             });
-        });
+        }
     }
 
     void removeReferencesToView (PatchView& v)
     {
-        std::scoped_lock lock (processLock);
         endpointListeners.removeReferencesToView (v);
     }
 
@@ -1507,7 +1657,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
         struct EventMonitor
         {
             EventMonitor (PatchView& v, const EndpointDetails& e, std::string type)
-                : view (v), endpointID (e.endpointID.toString()), replyType (std::move (type)), isMIDI (e.isMIDI())
+                : view (v), viewID (v.viewID), endpointID (e.endpointID.toString()), replyType (std::move (type)), isMIDI (e.isMIDI())
             {
             }
 
@@ -1515,7 +1665,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
             {
                 if (endpointID == endpoint)
                 {
-                    queue.postEndpointEvent (view, replyType, message);
+                    queue.postEndpointEvent (viewID, replyType, message);
                     return true;
                 }
 
@@ -1526,7 +1676,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
             {
                 if (isMIDI && endpointID == endpoint)
                 {
-                    queue.postEndpointMIDI (view, replyType, message);
+                    queue.postEndpointMIDI (viewID, replyType, message);
                     return true;
                 }
 
@@ -1539,13 +1689,16 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
             }
 
             PatchView& view;
+            const uint16_t viewID;
             const std::string endpointID, replyType;
             const bool isMIDI;
         };
 
-        void add (std::unique_ptr<EventMonitor> m)
+        using EventMonitorList = std::vector<std::shared_ptr<EventMonitor>>;
+
+        void add (std::shared_ptr<EventMonitor> m)
         {
-            eventMonitors.push_back (std::move (m));
+            eventMonitors.update ([&] (EventMonitorList& list) { list.push_back (std::move (m)); });
         }
 
         void add (const EndpointID& e, std::shared_ptr<PatchRenderer::DataListener> l)
@@ -1558,17 +1711,7 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
             if (auto l = findAudioDataListener (e))
                 return l->removeMonitor (view, e, replyType);
 
-            auto oldEnd = eventMonitors.end();
-            auto newEnd = std::remove_if (eventMonitors.begin(), oldEnd,
-                                          [&] (auto& m) { return m->isFor (view, e, replyType); });
-
-            if (newEnd != oldEnd)
-            {
-                eventMonitors.erase (newEnd, oldEnd);
-                return true;
-            }
-
-            return false;
+            return removeEventMonitorsIf ([&] (auto& m) { return m->isFor (view, e, replyType); });
         }
 
         DataListener* findAudioDataListener (const EndpointID& e) const
@@ -1579,29 +1722,60 @@ struct Patch::PatchRenderer  : public std::enable_shared_from_this<PatchRenderer
             return {};
         }
 
+        /// Calls a function for each event monitor. This can be called from the audio thread.
+        template <typename Fn>
+        void forEachEventMonitor (Fn&& fn)
+        {
+            RealtimeHandOver<EventMonitorList>::ScopedAccess list (eventMonitors);
+
+            if (list)
+                for (auto& m : *list)
+                    fn (*m);
+        }
+
         void sendOutputEventToViews (Patch& p, std::string_view endpointID, const choc::value::ValueView& value)
         {
             if (! value.isVoid())
-                for (auto& m : eventMonitors)
-                    if (m->endpointID == endpointID)
-                        p.sendMessageToView (m->view, m->replyType, value);
+                if (auto list = eventMonitors.get())
+                    for (auto& m : *list)
+                        if (m->endpointID == endpointID)
+                            p.sendMessageToView (m->view, m->replyType, value);
         }
 
         void removeReferencesToView (PatchView& v)
         {
-            auto oldEnd = eventMonitors.end();
-            auto newEnd = std::remove_if (eventMonitors.begin(), oldEnd,
-                                          [&] (auto& m) { return std::addressof (m->view) == std::addressof (v); });
-
-            if (newEnd != oldEnd)
-                eventMonitors.erase (newEnd, oldEnd);
+            removeEventMonitorsIf ([&] (auto& m) { return std::addressof (m->view) == std::addressof (v); });
 
             for (auto& d : dataListeners)
                 d.second->removeMonitorsForView (v);
         }
 
+        void releaseRetiredObjects()
+        {
+            eventMonitors.releaseRetiredObjects();
+
+            for (auto& d : dataListeners)
+                d.second->state.releaseRetiredObjects();
+        }
+
+        template <typename Predicate>
+        bool removeEventMonitorsIf (Predicate&& shouldRemove)
+        {
+            auto current = eventMonitors.get();
+
+            if (current == nullptr || std::none_of (current->begin(), current->end(), shouldRemove))
+                return false;
+
+            eventMonitors.update ([&] (EventMonitorList& list)
+            {
+                list.erase (std::remove_if (list.begin(), list.end(), shouldRemove), list.end());
+            });
+
+            return true;
+        }
+
         std::unordered_map<std::string, std::shared_ptr<DataListener>> dataListeners;
-        std::vector<std::unique_ptr<EventMonitor>> eventMonitors;
+        RealtimeHandOver<EventMonitorList> eventMonitors;
     };
 
     EndpointListeners endpointListeners;
@@ -1615,10 +1789,9 @@ private:
     TimelineEventGenerator timelineEvents;
     cmaj::EndpointID timeSigEventID, tempoEventID, transportStateEventID, positionEventID;
 
-    // The process callback is protected by a mutex that is uncontended during normal
-    // playback. The only times that another thread may lock it are when a newly compiled
-    // engine is being swapped over, or a new custom source is being applied.
-    std::mutex processLock;
+    // Used by resetToInitialState() to pass a fresh performer to the audio thread, and
+    // to get the old one back again, without either thread having to wait for the other.
+    std::atomic<cmaj::Performer*> pendingPerformer { nullptr }, performerToDelete { nullptr };
 };
 
 //==============================================================================
@@ -1779,11 +1952,14 @@ inline Patch::Patch()
     midiMessages.reserve (midiBufferSize);
 
     clientEventQueue = std::make_unique<ClientEventQueue> (*this);
+    retiredObjectReleaseThread.start (200, [this] { releaseRetiredObjects(); });
 }
 
 inline Patch::~Patch()
 {
     unload();
+    retiredObjectReleaseThread.stop();
+    rendererForAudioThread.releaseRetiredObjects();
     clientEventQueue.reset();
 }
 
@@ -1892,7 +2068,11 @@ inline void Patch::unload()
         if (stopPlayback)
             stopPlayback();
 
+        playable = false;
+        rendererForAudioThread.set ({});
+        renderer->stopMessageThreadTasks();
         renderer.reset();
+        releaseRetiredObjects();
         sendPatchChange();
         setStatus ({});
         customAudioInputSources.clear();
@@ -2054,7 +2234,7 @@ inline std::string Patch::getManifestFile() const
     return {};
 }
 
-inline bool Patch::isPlayable() const                       { return renderer != nullptr && renderer->isPlayable(); }
+inline bool Patch::isPlayable() const                       { return playable; }
 inline std::string Patch::getDescription() const            { return renderer != nullptr ? renderer->manifest.description : std::string(); }
 inline std::string Patch::getManufacturer() const           { return renderer != nullptr ? renderer->manifest.manufacturer : std::string(); }
 inline std::string Patch::getVersion() const                { return renderer != nullptr ? renderer->manifest.version : std::string(); }
@@ -2118,8 +2298,7 @@ inline void Patch::addMIDIMessage (int frameIndex, const void* data, uint32_t le
         midiMessages.push_back (message);
         midiMessageTimes.push_back (frameIndex);
 
-        if (renderer != nullptr)
-            renderer->processMIDIMessage (message);
+        withAudioThreadRenderer ([&] (PatchRenderer& r) { r.processMIDIMessage (message); });
     }
 }
 
@@ -2127,10 +2306,33 @@ inline void Patch::process (float* const* audioChannels, uint32_t numFrames,
                             const choc::audio::AudioMIDIBlockDispatcher::HandleMIDIMessageFn& handleMIDIOut)
 {
     beginChunkedProcess();
-    renderer->getPerformer().processWithTimeStampedMIDI (choc::buffer::createChannelArrayView (audioChannels, currentPlaybackParams.numInputChannels, numFrames),
-                                                         choc::buffer::createChannelArrayView (audioChannels, currentPlaybackParams.numOutputChannels, numFrames),
-                                                         midiMessages.data(), midiMessageTimes.data(), static_cast<uint32_t> (midiMessages.size()),
-                                                         handleMIDIOut, true);
+
+    if (audioThreadRenderer != nullptr)
+        audioThreadRenderer->getPerformer().processWithTimeStampedMIDI (choc::buffer::createChannelArrayView (audioChannels, currentPlaybackParams.numInputChannels, numFrames),
+                                                                        choc::buffer::createChannelArrayView (audioChannels, currentPlaybackParams.numOutputChannels, numFrames),
+                                                                        midiMessages.data(), midiMessageTimes.data(), static_cast<uint32_t> (midiMessages.size()),
+                                                                        handleMIDIOut, true);
+    else
+        choc::buffer::createChannelArrayView (audioChannels, currentPlaybackParams.numOutputChannels, numFrames).clear();
+
+    midiMessages.clear();
+    midiMessageTimes.clear();
+    endChunkedProcess();
+}
+
+inline void Patch::process (double* const* audioChannels, uint32_t numFrames,
+                            const choc::audio::AudioMIDIBlockDispatcher::HandleMIDIMessageFn& handleMIDIOut)
+{
+    beginChunkedProcess();
+
+    if (audioThreadRenderer != nullptr)
+        audioThreadRenderer->getPerformer().processWithTimeStampedMIDI (choc::buffer::createChannelArrayView (audioChannels, currentPlaybackParams.numInputChannels, numFrames),
+                                                                        choc::buffer::createChannelArrayView (audioChannels, currentPlaybackParams.numOutputChannels, numFrames),
+                                                                        midiMessages.data(), midiMessageTimes.data(), static_cast<uint32_t> (midiMessages.size()),
+                                                                        handleMIDIOut, true);
+    else
+        choc::buffer::createChannelArrayView (audioChannels, currentPlaybackParams.numOutputChannels, numFrames).clear();
+
     midiMessages.clear();
     midiMessageTimes.clear();
     endChunkedProcess();
@@ -2143,23 +2345,57 @@ inline void Patch::process (const choc::audio::AudioMIDIBlockDispatcher::Block&
     endChunkedProcess();
 }
 
+inline void Patch::process (const AudioMIDIPerformer::DoublePrecisionBlock& block, bool replaceOutput)
+{
+    beginChunkedProcess();
+    processChunk (block, replaceOutput);
+    endChunkedProcess();
+}
+
 inline void Patch::beginChunkedProcess()
 {
     clientEventQueue->startOfProcessCallback();
-    renderer->beginProcessBlock();
+    audioThreadRenderer = rendererForAudioThread.acquire();
+
+    if (audioThreadRenderer != nullptr)
+        audioThreadRenderer->beginProcessBlock();
 }
 
 inline void Patch::processChunk (const choc::audio::AudioMIDIBlockDispatcher::Block& block, bool replaceOutput)
 {
-    renderer->getPerformer().process (block, replaceOutput);
+    if (audioThreadRenderer == nullptr)
+    {
+        if (replaceOutput)
+            block.audioOutput.clear();
+
+        return;
+    }
+
+    audioThreadRenderer->getPerformer().process (block, replaceOutput);
+    clientEventQueue->postProcessChunk (block);
+    audioThreadRenderer->processMIDIBlock (block);
+}
+
+inline void Patch::processChunk (const AudioMIDIPerformer::DoublePrecisionBlock& block, bool replaceOutput)
+{
+    if (audioThreadRenderer == nullptr)
+    {
+        if (replaceOutput)
+            block.audioOutput.clear();
+
+        return;
+    }
+
+    audioThreadRenderer->getPerformer().process (block, replaceOutput);
     clientEventQueue->postProcessChunk (block);
-    renderer->processMIDIBlock (block);
+    audioThreadRenderer->processMIDIBlock (block);
 }
 
 inline void Patch::endChunkedProcess()
 {
-    clientEventQueue->endOfProcessCallback();
-    renderer->endProcessBlock();
+    clientEventQueue->endOfProcessCallback (audioThreadRenderer != nullptr ? audioThreadRenderer->getPerformerPointer() : nullptr);
+    audioThreadRenderer = nullptr;
+    rendererForAudioThread.release();
 }
 
 inline void Patch::failedToPushToPatch()
@@ -2170,22 +2406,22 @@ inline void Patch::failedToPushToPatch()
 
 inline void Patch::sendTimeSig (int numerator, int denominator, uint32_t timeoutMilliseconds)
 {
-    renderer->sendTimeSig (numerator, denominator, timeoutMilliseconds);
+    withAudioThreadRenderer ([&] (PatchRenderer& r) { r.sendTimeSig (numerator, denominator, timeoutMilliseconds); });
 }
 
 inline void Patch::sendBPM (float bpm, uint32_t timeoutMilliseconds)
 {
-    renderer->sendBPM (bpm, timeoutMilliseconds);
+    withAudioThreadRenderer ([&] (PatchRenderer& r) { r.sendBPM (bpm, timeoutMilliseconds); });
 }
 
 inline void Patch::sendTransportState (bool isRecording, bool isPlaying, bool isLooping, uint32_t timeoutMilliseconds)
 {
-    renderer->sendTransportState (isRecording, isPlaying, isLooping, timeoutMilliseconds);
+    withAudioThreadRenderer ([&] (PatchRenderer& r) { r.sendTransportState (isRecording, isPlaying, isLooping, timeoutMilliseconds); });
 }
 
 inline void Patch::sendPosition (int64_t currentFrame, double ppq, double ppqBar, uint32_t timeoutMilliseconds)
 {
-    renderer->sendPosition (currentFrame, ppq, ppqBar, timeoutMilliseconds);
+    withAudioThreadRenderer ([&] (PatchRenderer& r) { r.sendPosition (currentFrame, ppq, ppqBar, timeoutMilliseconds); });
 }
 
 inline void Patch::sendMessageToView (PatchView& view, std::string_view type, const choc::value::ValueView& message) const
@@ -2325,10 +2561,17 @@ inline void Patch::sendParameterChangeToViews (const EndpointID& endpointID, flo
                                                      "value", value));
 }
 
-inline void Patch::sendCPUInfoToViews (float level) const
+inline void Patch::sendCPUInfoToViews (float level, const choc::value::ValueView& nodeLevels) const
 {
-    broadcastMessageToViews ("cpu_info",
-                             choc::json::create ("level", level));
+    auto message = choc::json::create ("level", level);
+
+    if (nodeLevels.isArray())
+        message.addMember ("nodes", nodeLevels);
+
+    broadcastMessageToViews ("cpu_info", message);
+
+    if (handleCPUInfo)
+        handleCPUInfo (message);
 }
 
 inline void Patch::sendStoredStateValueToViews (const std::string& key) const
@@ -2361,11 +2604,27 @@ inline void Patch::setNewRenderer (std::shared_ptr<PatchRenderer> newRenderer)
     if (currentPlaybackParams != newRenderer->configuredPlaybackParams)
         return;
 
-    if (stopPlayback)
+    // If a playable patch is being replaced by another one, the audio thread just
+    // switches over to the new renderer at the start of its next block, so there's
+    // no need to stop and restart the audio device.
+    const bool wasPlayable = isPlayable();
+    const bool willBePlayable = newRenderer != nullptr && newRenderer->isPlayable();
+
+    if (wasPlayable && ! willBePlayable && stopPlayback)
         stopPlayback();
 
     fileChangeChecker.reset();
-    renderer.reset();
+
+    playable = willBePlayable;
+    rendererForAudioThread.set (willBePlayable ? newRenderer : nullptr);
+    retiredObjectReleaseThread.trigger();
+
+    if (renderer != nullptr)
+    {
+        renderer->stopMessageThreadTasks();
+        renderer.reset();
+    }
+
     sendPatchChange();
 
     if (newRenderer != nullptr)
@@ -2375,10 +2634,12 @@ inline void Patch::setNewRenderer (std::shared_ptr<PatchRenderer> newRenderer)
 
         if (isPlayable())
         {
-            clientEventQueue->prepare (renderer->sampleRate);
+            if (! wasPlayable)
+                clientEventQueue->prepare (renderer->sampleRate);
+
             renderer->startPatchWorker();
 
-            if (startPlayback)
+            if (! wasPlayable && startPlayback)
                 startPlayback();
 
             if (handleInfiniteLoop)
@@ -2402,6 +2663,28 @@ inline void Patch::setNewRenderer (std::shared_ptr<PatchRenderer> newRenderer)
     startCheckingForChanges();
 }
 
+inline void Patch::releaseRetiredObjects()
+{
+    rendererForAudioThread.releaseRetiredObjects();
+
+    if (auto r = rendererForAudioThread.get())
+        r->releaseRetiredObjects();
+}
+
+template <typename Fn>
+bool Patch::withAudioThreadRenderer (Fn&& fn)
+{
+    // This may be called from the audio thread or any other thread, so never
+    // touches the `renderer` member, which belongs to the message thread
+    RealtimeHandOver<PatchRenderer>::ScopedAccess r (rendererForAudioThread);
+
+    if (! r)
+        return false;
+
+    fn (*r);
+    return true;
+}
+
 inline void Patch::addActiveView (PatchView& v)
 {
     activeViews.push_back (std::addressof (v));
@@ -2440,26 +2723,35 @@ inline void Patch::sendOutputEventToViews (uint64_t frame, std::string_view endp
 inline bool Patch::sendEventOrValueToPatch (const EndpointID& endpointID, const choc::value::ValueView& value,
                                             int32_t rampFrames, uint32_t timeoutMilliseconds)
 {
-    if (renderer == nullptr)
+    bool sent = false;
+
+    if (! withAudioThreadRenderer ([&] (PatchRenderer& r)
+                                   {
+                                       sent = r.sendEventOrValueToPatch (*clientEventQueue, endpointID, value,
+                                                                         rampFrames, timeoutMilliseconds);
+                                   }))
         return false;
 
-    if (renderer->sendEventOrValueToPatch (*clientEventQueue, endpointID, value, rampFrames, timeoutMilliseconds))
-        return true;
+    if (! sent)
+        failedToPushToPatch();
 
-    failedToPushToPatch();
-    return false;
+    return sent;
 }
 
 inline bool Patch::sendMIDIInputEvent (const EndpointID& endpointID, choc::midi::ShortMessage message, uint32_t timeoutMilliseconds)
 {
-    if (renderer == nullptr)
+    bool sent = false;
+
+    if (! withAudioThreadRenderer ([&] (PatchRenderer& r)
+                                   {
+                                       sent = r.sendMIDIInputEvent (*clientEventQueue, endpointID, message, timeoutMilliseconds);
+                                   }))
         return false;
 
-    if (renderer->sendMIDIInputEvent (*clientEventQueue, endpointID, message, timeoutMilliseconds))
-        return true;
+    if (! sent)
+        failedToPushToPatch();
 
-    failedToPushToPatch();
-    return false;
+    return sent;
 }
 
 inline void Patch::sendGestureStart (const EndpointID& endpointID)
@@ -163,9 +163,11 @@ struct PatchManifest
     std::function<choc::value::Value(const cmaj::ExternalVariable&)> createExternalResolverFunction() const;
 
     /// Parses and adds all the source files from this patch to the given Program,
-    /// returning true if no errors were encountered.
+    /// returning true if no errors were encountered. If a cache is provided, any files
+    /// that have been parsed before will be re-loaded from it.
     bool addSourceFilesToProgram (Program&, DiagnosticMessageList&,
-                                  const std::function<void()>& checkForStopSignal);
+                                  const std::function<void()>& checkForStopSignal,
+                                  CacheDatabaseInterface* optionalCache = nullptr);
 
 private:
     static void addStrings (std::vector<std::string>&, const choc::value::ValueView&);
@@ -456,25 +458,33 @@ inline std::function<choc::value::Value(const cmaj::ExternalVariable&)> PatchMan
 
 inline bool PatchManifest::addSourceFilesToProgram (Program& program,
                                                     DiagnosticMessageList& errors,
-                                                    const std::function<void()>& checkForStopSignal)
+                                                    const std::function<void()>& checkForStopSignal,
+                                                    CacheDatabaseInterface* cache)
 {
     if (needsToBuildSource)
     {
+        std::vector<Program::File> filesToParse;
+
         for (auto& file : sourceFiles)
         {
             checkForStopSignal();
 
             if (auto content = readFileContent (file))
             {
-                if (! program.parse (errors, getFullPathForFile (file), std::move (*content)))
-                    return false;
+                filesToParse.push_back ({ getFullPathForFile (file), std::move (*content) });
             }
             else
             {
-                errors.add (cmaj::DiagnosticMessage::createError ("Could not open source file: " + file, {}));
+                // parse the files before this one first, so that any errors are reported in order
+                if (program.parseFiles (errors, filesToParse, cache))
+                    errors.add (cmaj::DiagnosticMessage::createError ("Could not open source file: " + file, {}));
+
                 return false;
             }
         }
+
+        checkForStopSignal();
+        return program.parseFiles (errors, filesToParse, cache);
     }
 
     return true;
@@ -45,6 +45,8 @@ struct PerformerProxy  : public PerformerInterface
     double getLatency() override                                                                    { return target->getLatency(); }
     uint32_t getEventBufferSize() override                                                          { return target->getEventBufferSize(); }
     const char* getRuntimeError() override                                                          { return target->getRuntimeError(); }
+    const char* getProfiledNodeNames() override                                                     { return target->getProfiledNodeNames(); }
+    uint32_t getNodeProfile (uint64_t* dest, uint32_t maxNumNodes) override                         { return target->getNodeProfile (dest, maxNumNodes); }
 
     PerformerPtr target;
 };
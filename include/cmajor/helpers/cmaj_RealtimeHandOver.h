@@ -0,0 +1,167 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace cmaj
+{
+
+//==============================================================================
+/// Publishes a shared object to realtime threads without them ever having to wait
+/// on a lock or free any memory.
+///
+/// Any non-realtime thread may call set() to replace the object. Readers bracket
+/// their use of the object with acquire() and release() (or a ScopedAccess), and will
+/// pick up the newest object the next time they acquire it. Replaced objects are held
+/// in a retired list until no reader can still be using them, and are deleted by
+/// releaseRetiredObjects(), which should be called periodically from a non-realtime
+/// thread.
+///
+template <typename ObjectType>
+struct RealtimeHandOver
+{
+    using Ptr = std::shared_ptr<ObjectType>;
+
+    RealtimeHandOver() = default;
+    RealtimeHandOver (const RealtimeHandOver&) = delete;
+    RealtimeHandOver& operator= (const RealtimeHandOver&) = delete;
+
+    //==============================================================================
+    /// Replaces the object that the realtime thread will see. Safe to call from
+    /// any non-realtime thread.
+    void set (Ptr newObject)
+    {
+        std::vector<Ptr> objectsToDelete;
+
+        std::scoped_lock lock (writerLock);
+        published.store (newObject.get());
+
+        if (current != nullptr)
+            retired.push_back (std::move (current));
+
+        current = std::move (newObject);
+        takeUnusedRetiredObjects (objectsToDelete);
+    }
+
+    /// Returns the most recently published object. This is for use by non-realtime
+    /// threads only.
+    Ptr get() const
+    {
+        std::scoped_lock lock (writerLock);
+        return current;
+    }
+
+    /// Makes a copy of the current object, passes it to the given function to modify,
+    /// and then publishes the result. Returns whatever the function returns.
+    template <typename ModifyFn>
+    auto update (ModifyFn&& modify)
+    {
+        std::scoped_lock lock (updateLock);
+        auto oldObject = get();
+        auto newObject = oldObject != nullptr ? std::make_shared<ObjectType> (*oldObject)
+                                              : std::make_shared<ObjectType>();
+
+        if constexpr (std::is_void_v<decltype (modify (*newObject))>)
+        {
+            modify (*newObject);
+            set (std::move (newObject));
+        }
+        else
+        {
+            auto result = modify (*newObject);
+            set (std::move (newObject));
+            return result;
+        }
+    }
+
+    /// Deletes any retired objects which the realtime thread is no longer using.
+    /// Safe to call from any non-realtime thread.
+    void releaseRetiredObjects()
+    {
+        std::vector<Ptr> objectsToDelete;
+
+        {
+            std::scoped_lock lock (writerLock);
+            takeUnusedRetiredObjects (objectsToDelete);
+        }
+    }
+
+    bool hasRetiredObjects() const
+    {
+        std::scoped_lock lock (writerLock);
+        return ! retired.empty();
+    }
+
+    //==============================================================================
+    /// Returns the current object, which the caller may use until it calls release().
+    /// This never blocks, and may return nullptr. Calls may be nested.
+    ObjectType* acquire()
+    {
+        activeReaders.fetch_add (1);
+        return published.load();
+    }
+
+    /// Must be called once for each call to acquire(), when the caller has finished
+    /// with the object that it returned.
+    void release()
+    {
+        activeReaders.fetch_sub (1);
+    }
+
+    /// An RAII helper that acquires the object for the lifetime of this object.
+    struct ScopedAccess
+    {
+        ScopedAccess (RealtimeHandOver& h) : handOver (h), object (h.acquire()) {}
+        ~ScopedAccess()     { handOver.release(); }
+
+        ObjectType* operator->() const      { return object; }
+        ObjectType& operator*() const       { return *object; }
+        explicit operator bool() const      { return object != nullptr; }
+
+        RealtimeHandOver& handOver;
+        ObjectType* const object;
+    };
+
+private:
+    //==============================================================================
+    Ptr current;
+    std::vector<Ptr> retired;
+    std::atomic<ObjectType*> published { nullptr };
+    std::atomic<uint32_t> activeReaders { 0 };
+    mutable std::mutex writerLock;
+    std::mutex updateLock;
+
+    // Any reader that arrives after an object was retired will be given a newer one, so
+    // once there are no active readers, nothing can still be using the retired objects.
+    // They're moved into a list which the caller destroys after releasing the lock, so
+    // that their destructors can safely call back into this class.
+    void takeUnusedRetiredObjects (std::vector<Ptr>& objectsToDelete)
+    {
+        if (activeReaders.load() == 0)
+            std::swap (objectsToDelete, retired);
+    }
+};
+
+} // namespace cmaj
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <array>
 #include <unordered_map>
 #include <unordered_set>
 #include <sstream>
@@ -35,7 +35,20 @@ struct Allocator
     }
 
     template <typename Type, typename... Args>
-    Type& allocate (Args&&... args)   { return pool.allocate<Type> (std::forward<Args> (args)...); }
+    Type& allocate (Args&&... args)
+    {
+        ++numObjectsAllocated;
+        numBytesAllocated += sizeof (Type);
+
+        if constexpr (std::is_base_of_v<Object, Type>)
+        {
+            auto& stats = objectClassStats[Type::classID];
+            ++stats.numObjects;
+            stats.numBytes += sizeof (Type);
+        }
+
+        return pool.allocate<Type> (std::forward<Args> (args)...);
+    }
 
     ObjectContext getContext (CodeLocation location, ptr<Object> parentScope)      { return { *this, location, parentScope }; }
     ObjectContext getContextWithoutLocation (ptr<Object> parentScope)              { return getContext ({}, parentScope); }
@@ -121,6 +134,17 @@ struct Allocator
     choc::memory::Pool pool;
     SourceFileList sourceFileList;
 
+    /// Running totals of the objects created by allocate(), for use in build statistics
+    uint64_t numObjectsAllocated = 0, numBytesAllocated = 0;
+
+    /// Running totals of the AST objects created by allocate(), indexed by their class ID
+    struct ObjectClassStats
+    {
+        uint64_t numObjects = 0, numBytes = 0;
+    };
+
+    std::array<ObjectClassStats, 256> objectClassStats;
+
     Strings strings { pool };
 
     const PrimitiveType& voidType;
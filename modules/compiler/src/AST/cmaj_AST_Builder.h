@@ -544,6 +544,19 @@ static inline ptr<AST::Object> createObjectOfClassType (AST::ObjectContext& cont
     }
 }
 
+/// Returns the name of the AST class with this ID number
+static inline std::string_view getObjectClassName (uint8_t classID)
+{
+    switch (classID)
+    {
+        #define CMAJ_GET_CLASS_NAME(name)   case name::classID:  return #name;
+        CMAJ_AST_CLASSES(CMAJ_GET_CLASS_NAME)
+        #undef CMAJ_GET_CLASS_NAME
+
+        default: return {};
+    }
+}
+
 static inline AST::NamespaceSeparator& createNamespaceSeparator (const ObjectContext& context, AST::Expression& lhs, AST::Expression& rhs)
 {
     auto& separator = context.allocate<AST::NamespaceSeparator>();
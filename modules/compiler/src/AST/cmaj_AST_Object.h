@@ -422,7 +422,7 @@ private:
     friend struct Visitor;
 
     static constexpr uint16_t maxActiveVisitorStackDepth = 4;
-    uint32_t activeVisitors[maxActiveVisitorStackDepth] = {};
+    uint16_t activeVisitors[maxActiveVisitorStackDepth] = {};
 
     bool checkAndUpdateVisitorStatus (uint32_t visitorDepth, uint16_t visitorID)
     {
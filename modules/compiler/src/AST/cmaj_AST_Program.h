@@ -30,10 +30,14 @@ struct Program  : public choc::com::ObjectWithAtomicRefCount<cmaj::ProgramInterf
 
     void parse (const SourceFile&, bool isSystemModule);
 
-    choc::com::String* parse (const char* filename, const char* fileContent, size_t fileContentSize) override
+    choc::com::String* parse (const char* filename, const char* fileContent, size_t fileContentSize,
+                              CacheDatabaseInterface* optionalCache) override
     {
         return catchAllErrorsAsJSON (false, [&]
         {
+            if (optionalCache != nullptr)
+                moduleCache = optionalCache;
+
             auto& code = allocator.sourceFileList.add (filename != nullptr ? std::string (filename) : std::string(),
                                                        fileContent != nullptr && fileContentSize != 0 ? std::string (fileContent, fileContentSize) : std::string(),
                                                        false);
@@ -43,6 +47,28 @@ struct Program  : public choc::com::ObjectWithAtomicRefCount<cmaj::ProgramInterf
         });
     }
 
+    choc::com::String* parseFiles (uint32_t numFiles, const char* const* filenames, const char* const* fileContents,
+                                   const size_t* fileContentSizes, CacheDatabaseInterface* optionalCache) override
+    {
+        return catchAllErrorsAsJSON (false, [&]
+        {
+            if (optionalCache != nullptr)
+                moduleCache = optionalCache;
+
+            auto firstNewFile = allocator.sourceFileList.sourceFiles.size();
+
+            for (uint32_t i = 0; i < numFiles; ++i)
+                allocator.sourceFileList.add (filenames[i] != nullptr ? std::string (filenames[i]) : std::string(),
+                                              fileContents[i] != nullptr && fileContentSizes[i] != 0 ? std::string (fileContents[i], fileContentSizes[i]) : std::string(),
+                                              false);
+
+            parseSourceFiles (firstNewFile);
+
+            for (auto i = firstNewFile; i < allocator.sourceFileList.sourceFiles.size(); ++i)
+                codeHash.addInput (allocator.sourceFileList.sourceFiles[i]->content);
+        });
+    }
+
     /// Adds the standard library, and if the program has already been loaded and is
     /// mashed-up, reparses it from the original source files
     bool prepareForLoading()
@@ -162,8 +188,7 @@ struct Program  : public choc::com::ObjectWithAtomicRefCount<cmaj::ProgramInterf
 
         cmaj::catchAllErrors (messageList, [&]
         {
-            for (auto& sourceFile : allocator.sourceFileList.sourceFiles)
-                parse (*sourceFile, false);
+            parseSourceFiles (0);
         });
 
         return ! messageList.hasErrors();
@@ -241,8 +266,15 @@ struct Program  : public choc::com::ObjectWithAtomicRefCount<cmaj::ProgramInterf
 private:
     mutable ptr<AST::ProcessorBase> mainProcessor;
     bool needsReparsing = false;
+    CacheDatabaseInterface::Ptr moduleCache;
+
+    static constexpr size_t minThreadsForParallelParse = 4;
+    static constexpr size_t minSourceSizeForParallelParse = 32 * 1024;
 
     void addStandardLibraryCode();
+    bool parseFromModuleCache (const SourceFile&, const std::string& cacheKey);
+    void parseSourceFiles (size_t firstFileIndex);
+    std::string getModuleCacheKey (const SourceFile&, bool isSystemModule) const;
 };
 
 static Program& getProgram (cmaj::ProgramInterface& p)
@@ -378,7 +378,7 @@ CMAJ_DECLARE_ENUM_PROPERTY (BinaryOpTypeEnum, add = 0, subtract = 1, multiply =
 
 CMAJ_DECLARE_ENUM_PROPERTY (EndpointTypeEnum, stream = 0, value = 1, event = 2)
 
-CMAJ_DECLARE_ENUM_PROPERTY (InterpolationTypeEnum, none = 0, latch = 1, linear = 2, sinc = 3, fast = 4, best = 5)
+CMAJ_DECLARE_ENUM_PROPERTY (InterpolationTypeEnum, none = 0, latch = 1, linear = 2, sinc = 3, fast = 4, best = 5, polyphase = 6)
 
 CMAJ_DECLARE_ENUM_PROPERTY (ProcessorPropertyEnum, frequency = 0, period = 1, id = 2, session = 3, latency = 4, maxFrequency = 5)
 
@@ -53,7 +53,7 @@ struct StringPool
         strings.reserve (256);
     }
 
-    PooledString get (const std::string& s)
+    PooledString get (std::string_view s)
     {
         if (s.empty())
             return {};
@@ -69,16 +69,19 @@ struct StringPool
         std::memcpy (text, s.data(), length);
 
         auto ps = PooledString (sv);
-        strings[s] = ps;
+        strings.emplace (*sv, ps);
         return ps;
     }
 
-    PooledString get (std::string_view s)   { return get (std::string (s)); }
-    PooledString get (const char* s)        { return get (std::string (s)); }
+    PooledString get (const std::string& s)     { return get (std::string_view (s)); }
+    PooledString get (const char* s)            { return get (std::string_view (s)); }
 
 private:
     choc::memory::Pool& pool;
-    std::unordered_map<std::string, PooledString> strings;
+
+    // The keys point at the pooled copies of the strings, so looking one up never
+    // needs to allocate, and each string's text is only stored once
+    std::unordered_map<std::string_view, PooledString> strings;
 };
 
 
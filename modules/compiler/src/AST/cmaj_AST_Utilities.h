@@ -30,6 +30,7 @@ using ArraySize = uint32_t;
 
 static constexpr std::string_view getSpecialisedFunctionSuffix()     { return "_specialised"; }
 static constexpr std::string_view getBinaryProgramHeader()           { return "Cmaj0001"; }
+static constexpr std::string_view getBinaryProgramWithLocationsHeader()  { return "Cmaj0L01"; }
 
 static bool isSpecialFunctionName (const Strings& sp, PooledString name)
 {
@@ -818,6 +818,7 @@ private:
         if (skipIfKeywordOrIdentifier ("sinc"))   return AST::InterpolationTypeEnum::Enum::sinc;
         if (skipIfKeywordOrIdentifier ("fast"))   return AST::InterpolationTypeEnum::Enum::fast;
         if (skipIfKeywordOrIdentifier ("best"))   return AST::InterpolationTypeEnum::Enum::best;
+        if (skipIfKeywordOrIdentifier ("polyphase")) return AST::InterpolationTypeEnum::Enum::polyphase;
 
         throwError (Errors::expectedInterpolationType());
     }
@@ -16,6 +16,8 @@
 //  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
 //  DISCLAIMED.
 
+#include <thread>
+#include <atomic>
 #include "../../include/cmaj_ErrorHandling.h"
 #include "../../../../include/cmajor/COM/cmaj_Library.h"
 #include "cmaj_AST.h"
@@ -39,10 +41,232 @@ namespace cmaj
 
     void AST::Program::parse (const SourceFile& source, bool isSystemModule)
     {
-        Parser::parseModuleDeclarations (allocator, source, isSystemModule, parsingComments, rootNamespace, {});
+        if (moduleCache == nullptr || transformations::isValidBinaryModuleData (source.content.data(), source.content.size()))
+        {
+            Parser::parseModuleDeclarations (allocator, source, isSystemModule, parsingComments, rootNamespace, {});
+        }
+        else
+        {
+            auto cacheKey = getModuleCacheKey (source, isSystemModule);
+
+            if (! parseFromModuleCache (source, cacheKey))
+            {
+                // Parse into an empty namespace, so that we can store exactly the set of
+                // top-level modules that came from this file
+                auto& parsedCode = allocator.createNamespace (allocator.strings.rootNamespaceName);
+                Parser::parseModuleDeclarations (allocator, source, isSystemModule, parsingComments, parsedCode, {});
+
+                // top-level aliases aren't modules, so a file containing any can't be stored
+                if (parsedCode.aliases.empty())
+                {
+                    auto data = transformations::createBinaryModule (parsedCode.getSubModules(), source.content);
+                    moduleCache->store (cacheKey.c_str(), data.data(), data.size());
+                }
+
+                rootNamespace.subModules.moveListItems (parsedCode.subModules);
+                rootNamespace.aliases.moveListItems (parsedCode.aliases);
+                transformations::mergeDuplicateNamespaces (rootNamespace);
+            }
+        }
+
+        resetMainProcessor();
+    }
+
+    void AST::Program::parseSourceFiles (size_t firstFileIndex)
+    {
+        auto& sourceFiles = allocator.sourceFileList.sourceFiles;
+        auto numFiles = sourceFiles.size() - std::min (firstFileIndex, sourceFiles.size());
+
+        if (numFiles <= 1 || std::thread::hardware_concurrency() < minThreadsForParallelParse)
+        {
+            for (auto i = firstFileIndex; i < sourceFiles.size(); ++i)
+                parse (*sourceFiles[i], false);
+
+            return;
+        }
+
+        // Each file is parsed by a worker thread into its own temporary allocator, and
+        // handed back as a binary module with source locations. These are then loaded
+        // in the original order on this thread, so the result is the same as a serial parse.
+        struct ParsedFile
+        {
+            std::vector<uint8_t> binaryModule;
+            DiagnosticMessageList messages;
+            std::string cacheKey;
+            bool needsSerialParse = false, isFromCache = false;
+        };
+
+        std::vector<ParsedFile> parsedFiles (numFiles);
+        size_t numFilesToParse = 0, sizeToParse = 0, largestFileSize = 0;
+
+        for (size_t i = 0; i < numFiles; ++i)
+        {
+            auto& source = *sourceFiles[firstFileIndex + i];
+            auto& parsed = parsedFiles[i];
+
+            if (transformations::isValidBinaryModuleData (source.content.data(), source.content.size()))
+            {
+                parsed.needsSerialParse = true;
+            }
+            else if (moduleCache != nullptr)
+            {
+                parsed.cacheKey = getModuleCacheKey (source, false);
+
+                if (auto cachedSize = moduleCache->reload (parsed.cacheKey.c_str(), nullptr, 0))
+                {
+                    parsed.binaryModule.resize (static_cast<size_t> (cachedSize));
+
+                    parsed.isFromCache = moduleCache->reload (parsed.cacheKey.c_str(), parsed.binaryModule.data(), cachedSize) == cachedSize;
+
+                    if (! parsed.isFromCache)
+                        parsed.binaryModule.clear();
+                }
+            }
+
+            if (! parsed.needsSerialParse && parsed.binaryModule.empty())
+            {
+                ++numFilesToParse;
+                sizeToParse += source.content.length();
+                largestFileSize = std::max (largestFileSize, source.content.length());
+            }
+        }
+
+        // Loading the binary modules back on this thread takes about half as long as parsing
+        // the code, and can't start until the slowest file is done, so it's only worth using
+        // workers for plenty of code, spread over enough files to keep several threads busy
+        auto numThreads = std::min (static_cast<size_t> (std::thread::hardware_concurrency()), numFilesToParse);
+
+        if (numThreads < minThreadsForParallelParse
+             || sizeToParse < minSourceSizeForParallelParse
+             || largestFileSize > sizeToParse / 2)
+        {
+            numThreads = 1;
+
+            for (auto& parsed : parsedFiles)
+                if (parsed.binaryModule.empty())
+                    parsed.needsSerialParse = true;
+        }
+
+        std::atomic<size_t> nextFile { 0 };
+
+        auto parseNextFiles = [&]
+        {
+            for (;;)
+            {
+                auto i = nextFile++;
+
+                if (i >= numFiles)
+                    return;
+
+                auto& parsed = parsedFiles[i];
+
+                if (parsed.needsSerialParse || ! parsed.binaryModule.empty())
+                    continue;
+
+                auto& source = *sourceFiles[firstFileIndex + i];
+
+                cmaj::catchAllErrors (parsed.messages, [&]
+                {
+                    // This only needs an allocator rather than a whole program, which would
+                    // also have to load the standard library
+                    AST::Allocator workerAllocator;
+                    auto& sourceCopy = workerAllocator.sourceFileList.add (source.filename, source.content, source.isSystem);
+                    auto& parsedCode = workerAllocator.createNamespace (workerAllocator.strings.rootNamespaceName);
+
+                    Parser::parseModuleDeclarations (workerAllocator, sourceCopy, false, parsingComments, parsedCode, {});
+
+                    // top-level aliases aren't modules, so can't go into a binary module
+                    if (parsedCode.aliases.empty())
+                        parsed.binaryModule = transformations::createBinaryModule (parsedCode.getSubModules(), sourceCopy.content);
+                    else
+                        parsed.needsSerialParse = true;
+                });
+            }
+        };
+
+        if (numThreads > 1)
+        {
+            std::vector<std::thread> workers;
+
+            for (size_t i = 1; i < numThreads; ++i)
+                workers.emplace_back (parseNextFiles);
+
+            parseNextFiles();
+
+            for (auto& w : workers)
+                w.join();
+        }
+
+        for (size_t i = 0; i < numFiles; ++i)
+        {
+            auto& source = *sourceFiles[firstFileIndex + i];
+            auto& parsed = parsedFiles[i];
+
+            if (! parsed.messages.empty())
+                cmaj::throwError (parsed.messages);
+
+            AST::ObjectRefVector<AST::ModuleBase> modules;
+
+            if (! parsed.needsSerialParse)
+                modules = transformations::parseBinaryModule (allocator, parsed.binaryModule.data(), parsed.binaryModule.size(),
+                                                              parsed.isFromCache, source.content);
+
+            // anything that couldn't be passed back as a binary module just gets parsed here
+            if (modules.empty())
+            {
+                parse (source, false);
+                continue;
+            }
+
+            for (auto& m : modules)
+                rootNamespace.subModules.addChildObject (m);
+
+            transformations::mergeDuplicateNamespaces (rootNamespace);
+
+            if (moduleCache != nullptr && ! parsed.isFromCache)
+                moduleCache->store (parsed.cacheKey.c_str(), parsed.binaryModule.data(), parsed.binaryModule.size());
+        }
+
         resetMainProcessor();
     }
 
+    bool AST::Program::parseFromModuleCache (const SourceFile& source, const std::string& cacheKey)
+    {
+        if (auto cachedSize = moduleCache->reload (cacheKey.c_str(), nullptr, 0))
+        {
+            std::vector<uint8_t> data (static_cast<size_t> (cachedSize));
+
+            if (moduleCache->reload (cacheKey.c_str(), data.data(), cachedSize) == cachedSize)
+            {
+                auto modules = transformations::parseBinaryModule (allocator, data.data(), data.size(), true, source.content);
+
+                if (! modules.empty())
+                {
+                    for (auto& m : modules)
+                        rootNamespace.subModules.addChildObject (m);
+
+                    transformations::mergeDuplicateNamespaces (rootNamespace);
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    std::string AST::Program::getModuleCacheKey (const SourceFile& source, bool isSystemModule) const
+    {
+        // The filename isn't part of the key, because the stored source locations are
+        // just offsets into the content
+        choc::hash::xxHash64 hash;
+        hash.addInput (source.content);
+        hash.addInput (std::string_view (CMAJ_VERSION));
+        hash.addInput (std::string_view (isSystemModule ? "system" : "user"));
+        hash.addInput (std::string_view (parsingComments ? "comments" : ""));
+
+        return "module_" + choc::text::createHexString (hash.getHash());
+    }
+
     void AST::Program::addStandardLibraryCode()
     {
         for (auto& m : transformations::parseBinaryModule (allocator, standardLibraryData, sizeof (standardLibraryData), false))
@@ -254,6 +254,9 @@ struct LLVMEngine
 
             initialiseEndpointHandlers (codeGen, llvmEngine.engine.endpointHandles);
 
+            if (llvmEngine.engine.buildSettings.shouldProfileNodes())
+                initialiseProfiledNodes (codeGen);
+
             if (cache != nullptr && ! loadedFromCache)
                 codeGen.saveBitcodeToCache (*cache, cacheKey);
 
@@ -336,6 +339,15 @@ struct LLVMEngine
         std::vector<OutputValueEndpoint>  outputValues;
         std::vector<OutputEventEndpoint>  outputEvents;
 
+        struct ProfiledNode
+        {
+            std::string name;
+            size_t stateOffset = 0;
+        };
+
+        std::vector<ProfiledNode> profiledNodes;
+        std::string profiledNodeNamesJSON;
+
         static bool loadFromCache (LLVMCodeGenerator& codeGen, CacheDatabaseInterface* cache, const char* key)
         {
             if (cache != nullptr)
@@ -433,6 +445,52 @@ struct LLVMEngine
             }
         }
 
+        void initialiseProfiledNodes (LLVMCodeGenerator& codeGen)
+        {
+            size_t offset = 0;
+
+            if (auto counters = findNodeProfileStruct (codeGen, *codeGen.stateStruct, offset))
+            {
+                auto names = choc::value::createEmptyArray();
+
+                for (uint32_t i = 0; i < counters->memberNames.size(); ++i)
+                {
+                    auto name = std::string (counters->getMemberName (i).get());
+                    profiledNodes.push_back ({ name, offset + codeGen.getStructMemberOffset (*counters, i) });
+                    names.addArrayElement (name);
+                }
+
+                profiledNodeNamesJSON = choc::json::toString (names, false);
+            }
+        }
+
+        /// Searches the state (including the states of any wrapper processors) for the struct
+        /// that holds the node profiling counters, and finds its offset
+        static ptr<const AST::StructType> findNodeProfileStruct (LLVMCodeGenerator& codeGen, const AST::StructType& parent, size_t& offset)
+        {
+            for (uint32_t i = 0; i < parent.memberNames.size(); ++i)
+            {
+                if (auto s = parent.getMemberType (i).skipConstAndRefModifiers().getAsStructType())
+                {
+                    auto memberOffset = offset + codeGen.getStructMemberOffset (parent, i);
+
+                    if (parent.getMemberName (i) == transformations::NodeProfiling::stateMemberName)
+                    {
+                        offset = memberOffset;
+                        return *s;
+                    }
+
+                    if (auto found = findNodeProfileStruct (codeGen, *s, memberOffset))
+                    {
+                        offset = memberOffset;
+                        return found;
+                    }
+                }
+            }
+
+            return {};
+        }
+
         template <typename List>
         auto& getEndpointInfo (const List& endpoints, EndpointHandle handle)
         {
@@ -694,6 +752,21 @@ struct LLVMEngine
         }
 
         choc::value::StringDictionary& getDictionary()  { return code->stringDictionary; }
+
+        const char* getProfiledNodeNames()
+        {
+            return code->profiledNodes.empty() ? nullptr : code->profiledNodeNamesJSON.c_str();
+        }
+
+        uint32_t getNodeProfile (uint64_t* dest, uint32_t maxNumNodes) noexcept
+        {
+            auto num = std::min (maxNumNodes, static_cast<uint32_t> (code->profiledNodes.size()));
+
+            for (uint32_t i = 0; i < num; ++i)
+                dest[i] = static_cast<uint64_t> (*reinterpret_cast<const int64_t*> (statePointer + code->profiledNodes[i].stateOffset));
+
+            return num;
+        }
     };
 
     PerformerInterface* createPerformer (std::shared_ptr<LinkedCode> code)
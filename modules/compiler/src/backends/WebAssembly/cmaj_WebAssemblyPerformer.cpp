@@ -520,6 +520,10 @@ initialisePatch();
 
         Dictionary dictionary { *this };
         choc::value::StringDictionary& getDictionary()  { return dictionary; }
+
+        // This engine doesn't support external functions, so can't profile nodes
+        const char* getProfiledNodeNames()              { return {}; }
+        uint32_t getNodeProfile (uint64_t*, uint32_t)   { return 0; }
     };
 
 
@@ -24,6 +24,7 @@
 #include "../AST/cmaj_AST.h"
 #include "../codegen/cmaj_GraphGenerator.h"
 #include "../transformations/cmaj_Transformations.h"
+#include "../utilities/cmaj_PassTimer.h"
 #include "CPlusPlus/cmaj_CPlusPlus.h"
 #include "WebAssembly/cmaj_WebAssembly.h"
 #include "LLVM/cmaj_LLVM.h"
@@ -66,6 +67,8 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
     choc::com::StringPtr loadedProgramDetailsJSON;
     std::shared_ptr<typename Implementation::LinkedCode> linkedCode;
     CompilePerformanceTimes compilePerformanceTimes;
+    PassTimings passTimings;
+    std::string transformationNotes;
     std::vector<EndpointInfo> endpointHandles;
     uint32_t nextHandle = 1;
 
@@ -101,6 +104,7 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
         newProgram.reset();
         program.reset();
         loadedProgramDetailsJSON = {};
+        transformationNotes.clear();
     }
 
     bool isLoaded() override        { return loadedProgram != nullptr; }
@@ -137,10 +141,12 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
                              void* functionContext, EngineInterface::RequestExternalFunctionFn requestExternalFunction) override
     {
         unload();
+        passTimings = {};
 
         return AST::catchAllErrorsAsJSON (buildSettings.shouldIgnoreWarnings(), [&]
         {
             auto pc = compilePerformanceTimes.getCounter ("load");
+            auto timingCollector = createPassTimingCollector();
 
             if (programToLoad == nullptr)
                 throwError (Errors::emptyProgram());
@@ -155,7 +161,7 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
                 auto s = AST::print (*newProgram);
                 AST::Program p;
 
-                if (auto result = p.parse ({}, s.data(), s.length()))
+                if (auto result = p.parse ({}, s.data(), s.length(), nullptr))
                     throwError (Errors::staticAssertionFailureWithMessage ("RoundTrip error: " + std::string (result->get())));
             }
 
@@ -191,6 +197,7 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
             if (! isLoaded())
                 throwError (Errors::noProgramLoaded());
 
+            auto timingCollector = createPassTimingCollector();
             double latency = 0;
 
             {
@@ -204,7 +211,10 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
                                                     Implementation::supportsExternalFunctions,
                                                     Implementation::engineSupportsIntrinsic,
                                                     latency,
-                                                    [this] (const EndpointID& e) { return isEndpointActive (e); });
+                                                    [this] (const EndpointID& e) { return isEndpointActive (e); },
+                                                    std::addressof (transformationNotes));
+
+                addObjectClassMemoryUsage (*program);
             }
 
             {
@@ -212,10 +222,15 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
 
                 std::string cacheKey;
 
+                // The profiling timer is only bound when code is generated, so a profiled build can't be cached
+                if (buildSettings.shouldProfileNodes())
+                    cache = nullptr;
+
                 if (cache != nullptr)
                     cacheKey = getCacheKey();
 
                 bool isSingleFrameOnly = buildSettings.getMaxBlockSize() == 1;
+                PassTimer timer ("backendCodeGen", getProgram().allocator);
                 linkedCode = std::make_shared<typename Implementation::LinkedCode> (*implementation, isSingleFrameOnly,
                                                                                     latency, cache, cacheKey.c_str());
             }
@@ -224,7 +239,28 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
 
     choc::com::String* getLastBuildLog() override
     {
-        return choc::com::createRawString (compilePerformanceTimes.getResults());
+        auto log = compilePerformanceTimes.getResults();
+
+        if (! transformationNotes.empty())
+            log += "\n" + transformationNotes;
+
+        return choc::com::createRawString (log);
+    }
+
+    choc::com::String* getLastPassTimings() override
+    {
+        if (! buildSettings.shouldTimePasses())
+            return {};
+
+        return choc::com::createRawString (choc::json::toString (passTimings.toJSON(), true));
+    }
+
+    std::unique_ptr<PassTimingCollector> createPassTimingCollector()
+    {
+        if (buildSettings.shouldTimePasses())
+            return std::make_unique<PassTimingCollector> (passTimings);
+
+        return {};
     }
 
     std::string getCacheKey()
@@ -333,6 +369,8 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
             if (isLinked())
                 throwError (Errors::cannotGenerateIfLinked());
 
+            auto timingCollector = createPassTimingCollector();
+
             if (targetType == nullptr || std::string_view (targetType).empty())
                 throw std::runtime_error ("Must specify a code generation target type");
 
@@ -358,8 +396,9 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
             if (choc::text::startsWith (type, "javascript") || type == "wast")
                 engineSupportsIntrinsic = [] (AST::Intrinsic::Type) -> bool { return false; };
 
+            // Node profiling calls a native timer function, so it's only used by the JIT engines
             cmaj::transformations::prepareForCodeGen (*program,
-                                                      buildSettings,
+                                                      BuildSettings (buildSettings).setProfileNodes (false),
                                                       useForwardBranch,
                                                       true, // dynamic rate + session ID
                                                       true,
@@ -368,6 +407,8 @@ struct EngineBase  : public choc::com::ObjectWithAtomicRefCount<EngineInterface,
                                                       latency,
                                                       [this] (const EndpointID& e) { return isEndpointActive (e); });
 
+            addObjectClassMemoryUsage (*program);
+            PassTimer timer ("backendCodeGen", getProgram().allocator);
             bool outputTypeKnown = false;
             auto optionsString = optionsJSON != nullptr ? std::string_view (optionsJSON) : std::string_view();
             (void) optionsString;
@@ -451,6 +492,7 @@ struct PerformerBase  : public choc::com::ObjectWithAtomicRefCount<cmaj::Perform
     //==============================================================================
     void reset() override
     {
+        readPendingOutputEvents();
         jit.reset();
     }
 
@@ -472,6 +514,9 @@ struct PerformerBase  : public choc::com::ObjectWithAtomicRefCount<cmaj::Perform
 
     void addInputEvent (EndpointHandle handle, uint32_t typeIndex, const void* eventData) override
     {
+        // an event handler may write to an output, which would overwrite any
+        // events from the last block that haven't been read yet
+        readPendingOutputEvents();
         getEndpointHandler (handle).addInputEvent (typeIndex, eventData);
     }
 
@@ -494,8 +539,11 @@ struct PerformerBase  : public choc::com::ObjectWithAtomicRefCount<cmaj::Perform
     {
         jit.advance (numFramesToDo);
 
+        outputEventsPending = false;
+
         for (auto& e : outputEventHandlers)
-            e->moveOutputEventsToQueue();
+            if (e->startNewBlock())
+                outputEventsPending = true;
     }
 
     uint32_t getMaximumBlockSize() override     { return maxBlockSize; }
@@ -504,6 +552,9 @@ struct PerformerBase  : public choc::com::ObjectWithAtomicRefCount<cmaj::Perform
     uint32_t getXRuns() override                { return xruns; }
     const char* getRuntimeError() override      { return {}; }
 
+    const char* getProfiledNodeNames() override                                 { return jit.getProfiledNodeNames(); }
+    uint32_t getNodeProfile (uint64_t* dest, uint32_t maxNumNodes) override     { return jit.getNodeProfile (dest, maxNumNodes); }
+
     const char* getStringForHandle (uint32_t handle, size_t& stringLength) override
     {
         try
@@ -526,6 +577,8 @@ private:
     uint32_t numFramesToDo = 0,
              xruns = 0;
 
+    bool outputEventsPending = false;
+
     const uint32_t maxBlockSize, eventBufferSize;
     const double latency;
 
@@ -705,6 +758,7 @@ private:
 
         void iterateOutputEvents (void* context, PerformerInterface::HandleOutputEventCallback handler) override
         {
+            readPendingEvents();
             auto numEvents = queue.numEvents;
 
             for (uint32_t i = 0; i < numEvents; ++i)
@@ -716,31 +770,42 @@ private:
             }
         }
 
-        void moveOutputEventsToQueue()
+        /// Called after each block. This resets the count of events that the block produced,
+        /// but leaves the events themselves in the processor's state, and they're only unpacked
+        /// into the queue if something asks for them. Returns true if there were any events.
+        bool startNewBlock()
         {
             CMAJ_ASSERT (getNumOutputEvents != nullptr);
 
-            if (auto numEvents = getNumOutputEvents())
+            queue.numEvents = 0;
+            numPendingEvents = getNumOutputEvents();
+
+            if (numPendingEvents == 0)
+                return false;
+
+            if (numPendingEvents > queue.maxNumEvents)
             {
-                if (numEvents > queue.maxNumEvents)
-                {
-                    numEvents = queue.maxNumEvents;
-                    owner.registerXRun();
-                }
+                numPendingEvents = queue.maxNumEvents;
+                owner.registerXRun();
+            }
 
-                for (uint32_t i = 0; i < numEvents; ++i)
+            resetEventCount();
+            return true;
+        }
+
+        void readPendingEvents()
+        {
+            if (numPendingEvents != 0)
+            {
+                for (uint32_t i = 0; i < numPendingEvents; ++i)
                 {
                     auto& event = queue.getEvent (i);
                     event.type  = getEventTypeIndex (i);
                     event.frame = readOutputEvent (i, event.data);
                 }
 
-                queue.numEvents = numEvents;
-                resetEventCount();
-            }
-            else
-            {
-                queue.numEvents = 0;
+                queue.numEvents = numPendingEvents;
+                numPendingEvents = 0;
             }
         }
 
@@ -787,6 +852,7 @@ private:
         PerformerBase& owner;
         EndpointHandle handle;
         OutputEventQueue queue;
+        uint32_t numPendingEvents = 0;
 
         std::function<uint32_t()>                 getNumOutputEvents;
         std::function<uint32_t(uint32_t)>         getEventTypeIndex;
@@ -799,6 +865,17 @@ private:
     uint32_t firstHandle = 0, lastHandle = 0;
     std::vector<OutputEventHandler*> outputEventHandlers;
 
+    void readPendingOutputEvents()
+    {
+        if (outputEventsPending)
+        {
+            outputEventsPending = false;
+
+            for (auto& e : outputEventHandlers)
+                e->readPendingEvents();
+        }
+    }
+
     EndpointHandler& getEndpointHandler (EndpointHandle handle)
     {
         CMAJ_ASSERT (handle >= firstHandle && handle < lastHandle);
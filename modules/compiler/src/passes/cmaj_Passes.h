@@ -19,6 +19,7 @@
 #pragma once
 
 #include "../validation/cmaj_ValidationUtilities.h"
+#include "../utilities/cmaj_PassTimer.h"
 
 namespace cmaj::passes
 {
@@ -123,13 +124,18 @@ namespace cmaj::passes
         PassResult operator+ (PassResult other) const       { auto p = *this; p += other; return p; }
     };
 
+    /// Runs a pass over the whole program. The name is used to identify the pass in
+    /// any PassTimings that are being collected.
     template <typename PassType>
-    PassResult runPass (AST::Program& program, bool throwOnErrors)
+    PassResult runPass (AST::Program& program, bool throwOnErrors, std::string_view name)
     {
+        PassTimer timer (name, program.allocator);
+
         PassType pass (program);
         pass.throwOnErrors = throwOnErrors;
         pass.visitObject (program.rootNamespace);
 
+        timer.addChanges (pass.numReplaced);
         return { pass.numReplaced, pass.numFailures };
     }
 }
@@ -20,16 +20,24 @@ namespace cmaj::transformations
 {
 
 //==============================================================================
+/// Replaces calls to intrinsics which the engine can't handle with calls to the
+/// library functions in `internal::math_implementations`.
+///
+/// If useApproximateMaths is true, scalar float32 calls to sin, cos, exp, log, pow and
+/// tanh are replaced by the faster versions in `internal::approximate_math_implementations`,
+/// whether or not the engine supports them. Float64 and vector calls are left alone, as
+/// there are no approximations of those which beat the intrinsics.
 inline void addFallbackIntrinsics (AST::Program& program,
-                                   const std::function<bool(AST::Intrinsic::Type)>& engineSupportsIntrinsic)
+                                   const std::function<bool(AST::Intrinsic::Type)>& engineSupportsIntrinsic,
+                                   bool useApproximateMaths)
 {
     struct ReplaceIntrinsicsWithFallbacks  : public AST::NonParameterisedObjectVisitor
     {
         using super = AST::NonParameterisedObjectVisitor;
         using super::visit;
 
-        ReplaceIntrinsicsWithFallbacks (AST::Allocator& a, const std::function<bool(AST::Intrinsic::Type)>& f)
-            : super (a), engineSupportsIntrinsic (f) {}
+        ReplaceIntrinsicsWithFallbacks (AST::Allocator& a, const std::function<bool(AST::Intrinsic::Type)>& f, bool approximate)
+            : super (a), engineSupportsIntrinsic (f), useApproximateMaths (approximate) {}
 
         CMAJ_DO_NOT_VISIT_CONSTANTS
 
@@ -41,6 +49,9 @@ inline void addFallbackIntrinsics (AST::Program& program,
 
             if (intrin != AST::Intrinsic::Type::unknown)
             {
+                if (useApproximateMaths && replaceWithApproximation (fc, intrin))
+                    return;
+
                 if (! engineSupportsIntrinsic (intrin))
                 {
                     if (auto originalFunction = fc.getTargetFunction())
@@ -49,32 +60,21 @@ inline void addFallbackIntrinsics (AST::Program& program,
                             if (! paramType->isPrimitive())
                                 return;
 
-                        auto replaceFn = [&] (std::string_view name, uint32_t numArgs)
+                        auto replaceFn = [&] (std::string_view name)
                         {
-                            fc.intrinsicType.reset();
-                            auto intrinsicsNamespace = findIntrinsicsNamespaceFromRoot (fc.getRootNamespace());
-                            auto ns = intrinsicsNamespace
-                                         ->findChildModule (intrinsicsNamespace->getStringPool().get ("internal"))
-                                         ->findChildModule (intrinsicsNamespace->getStringPool().get ("math_implementations"));
-
-                            auto fallbackFn = ns->findFunction ([name, numArgs, originalFunction] (const AST::Function& f)
-                            {
-                                return f.getNumParameters() == numArgs && f.getName().get() == name && f.hasSameParameterTypes (*originalFunction);
-                            });
-
-                            fc.targetFunction.referTo (fallbackFn);
+                            replaceTargetFunction (fc, *originalFunction, "math_implementations", name);
                         };
 
                         switch (intrin)
                         {
-                            case AST::Intrinsic::Type::sin:     replaceFn ("sin",   1); break;
-                            case AST::Intrinsic::Type::cos:     replaceFn ("cos",   1); break;
-                            case AST::Intrinsic::Type::tan:     replaceFn ("tan",   1); break;
-                            case AST::Intrinsic::Type::log:     replaceFn ("log",   1); break;
-                            case AST::Intrinsic::Type::log10:   replaceFn ("log10", 1); break;
-                            case AST::Intrinsic::Type::exp:     replaceFn ("exp",   1); break;
-                            case AST::Intrinsic::Type::pow:     replaceFn ("pow",   2); break;
-                            case AST::Intrinsic::Type::fmod:    replaceFn ("fmod",  2); break;
+                            case AST::Intrinsic::Type::sin:     replaceFn ("sin");     break;
+                            case AST::Intrinsic::Type::cos:     replaceFn ("cos");     break;
+                            case AST::Intrinsic::Type::tan:     replaceFn ("tan");     break;
+                            case AST::Intrinsic::Type::log:     replaceFn ("log");     break;
+                            case AST::Intrinsic::Type::log10:   replaceFn ("log10");   break;
+                            case AST::Intrinsic::Type::exp:     replaceFn ("exp");     break;
+                            case AST::Intrinsic::Type::pow:     replaceFn ("pow");     break;
+                            case AST::Intrinsic::Type::fmod:    replaceFn ("fmod");    break;
 
                             case AST::Intrinsic::Type::isnan:
                             case AST::Intrinsic::Type::isinf:
@@ -111,10 +111,77 @@ inline void addFallbackIntrinsics (AST::Program& program,
             }
         }
 
+        bool replaceWithApproximation (AST::FunctionCall& fc, AST::Intrinsic::Type intrin)
+        {
+            std::string_view name;
+
+            switch (intrin)
+            {
+                case AST::Intrinsic::Type::sin:     name = "sin";   break;
+                case AST::Intrinsic::Type::cos:     name = "cos";   break;
+                case AST::Intrinsic::Type::exp:     name = "exp";   break;
+                case AST::Intrinsic::Type::log:     name = "log";   break;
+                case AST::Intrinsic::Type::pow:     name = "pow";   break;
+                case AST::Intrinsic::Type::tanh:    name = "tanh";  break;
+                default:                            return false;
+            }
+
+            auto originalFunction = fc.getTargetFunction();
+
+            if (originalFunction == nullptr)
+                return false;
+
+            auto paramTypes = originalFunction->getParameterTypes();
+
+            if (paramTypes.empty())
+                return false;
+
+            for (auto& paramType : paramTypes)
+                if (! paramType->isPrimitiveFloat32())
+                    return false;
+
+            return replaceTargetFunction (fc, *originalFunction, "approximate_math_implementations", name);
+        }
+
+        static bool replaceTargetFunction (AST::FunctionCall& fc, const AST::Function& originalFunction,
+                                           std::string_view namespaceName, std::string_view name)
+        {
+            auto intrinsicsNamespace = findIntrinsicsNamespaceFromRoot (fc.getRootNamespace());
+
+            if (intrinsicsNamespace == nullptr)
+                return false;
+
+            auto& strings = intrinsicsNamespace->getStringPool();
+            auto internalNamespace = intrinsicsNamespace->findChildModule (strings.get ("internal"));
+
+            if (internalNamespace == nullptr)
+                return false;
+
+            auto ns = internalNamespace->findChildModule (strings.get (namespaceName));
+
+            if (ns == nullptr)
+                return false;
+
+            auto numArgs = originalFunction.getNumParameters();
+
+            auto fallbackFn = ns->findFunction ([name, numArgs, &originalFunction] (const AST::Function& f)
+            {
+                return f.getNumParameters() == numArgs && f.getName().get() == name && f.hasSameParameterTypes (originalFunction);
+            });
+
+            if (fallbackFn == nullptr)
+                return false;
+
+            fc.intrinsicType.reset();
+            fc.targetFunction.referTo (fallbackFn);
+            return true;
+        }
+
         const std::function<bool(AST::Intrinsic::Type)>& engineSupportsIntrinsic;
+        const bool useApproximateMaths;
     };
 
-    ReplaceIntrinsicsWithFallbacks r (program.allocator, engineSupportsIntrinsic);
+    ReplaceIntrinsicsWithFallbacks r (program.allocator, engineSupportsIntrinsic, useApproximateMaths);
     r.visit (program.rootNamespace);
 }
 
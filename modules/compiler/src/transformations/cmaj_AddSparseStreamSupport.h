@@ -20,11 +20,182 @@ namespace cmaj::transformations
 {
 
 //==============================================================================
-inline void addSparseStreamSupport (AST::Program& program)
+/// Lets the flattened graph skip running nodes whose stream inputs are silent.
+///
+/// A processor opts in with a `[[ silenceTransparent: N ]]` annotation, which is a
+/// promise that once all of its stream inputs have been zero for N frames, its stream
+/// outputs will also be zero until an input becomes non-zero again. A stateless
+/// processor such as a gain can use `[[ silenceTransparent ]]` (i.e. N = 0), and
+/// a filter or delay would use the length of its tail.
+///
+/// Because the graph's io variables are cleared every frame, a skipped node's outputs
+/// are zero, so its downstream connections only accumulate silence.
+struct SparseStreamSupport
 {
-    auto& mainProcessor = program.getMainProcessor();
+    static constexpr std::string_view annotationName = "silenceTransparent";
 
-    (void) mainProcessor;
-}
+    /// Returns the number of silent frames after which a node of this processor may
+    /// stop running, or nullopt if it can't be skipped.
+    static std::optional<int32_t> getSilenceHoldFrames (const AST::ProcessorBase& processor)
+    {
+        auto annotation = AST::castTo<AST::Annotation> (processor.annotation);
+
+        if (annotation == nullptr)
+            return {};
+
+        auto value = annotation->findConstantProperty (annotationName);
+
+        if (value == nullptr)
+            return {};
+
+        std::optional<int32_t> holdFrames;
+
+        if (auto flag = value->getAsConstantBool())
+        {
+            if (flag->value.get())
+                holdFrames = 0;
+        }
+        else if (value->getAsConstantInt32() != nullptr || value->getAsConstantInt64() != nullptr)
+        {
+            auto numFrames = *value->getAsInt64();
+
+            if (numFrames >= 0 && numFrames <= std::numeric_limits<int32_t>::max())
+                holdFrames = static_cast<int32_t> (numFrames);
+        }
+
+        if (holdFrames && canCheckInputsForSilence (processor))
+            return holdFrames;
+
+        return {};
+    }
+
+    /// Creates the state variable which counts how many frames of silence the given
+    /// node has seen.
+    static AST::VariableReference& createSilentFrameCounter (AST::ProcessorBase& graph, const AST::GraphNode& node)
+    {
+        auto& int32Type = graph.context.allocator.int32Type;
+        ptr<const AST::TypeBase> counterType = int32Type;
+
+        if (auto arraySize = node.getArraySize())
+            counterType = AST::createArrayOfType (graph, int32Type, *arraySize);
+
+        auto& counter = AST::createStateVariable (graph, std::string (node.getName()) + "_silentFrames", counterType, {});
+        return AST::createVariableReference (graph.context, counter);
+    }
+
+    /// Adds a call to a node's main function which is only made if its stream inputs
+    /// have been non-zero within the last holdFrames frames. The counter is only needed
+    /// when holdFrames is greater than zero.
+    template <typename CreateRunCall>
+    static void addRunCallSkippingSilence (AST::ScopeBlock& block, std::string_view nodeName, const AST::ProcessorBase& processor,
+                                           AST::ValueBase& ioVariable, ptr<AST::ValueBase> silentFrameCounter,
+                                           int32_t holdFrames, CreateRunCall&& createRunCall)
+    {
+        auto& context = block.context;
+        auto& inputsAreSilent = createInputsAreSilentCheck (block, nodeName, processor, ioVariable);
+
+        if (holdFrames == 0)
+        {
+            block.addStatement (AST::createIfStatement (context, AST::createLogicalNot (context, inputsAreSilent),
+                                                        createRunCall()));
+            return;
+        }
+
+        CMAJ_ASSERT (silentFrameCounter != nullptr);
+
+        auto& whenSilent = context.allocate<AST::ScopeBlock>();
+        auto& runAndCount = context.allocate<AST::ScopeBlock>();
+        runAndCount.addStatement (AST::createPreInc (context, *silentFrameCounter));
+        runAndCount.addStatement (createRunCall());
+
+        whenSilent.addStatement (AST::createIfStatement (context,
+                                                         AST::createBinaryOp (context, AST::BinaryOpTypeEnum::Enum::lessThan,
+                                                                              *silentFrameCounter,
+                                                                              context.allocator.createConstantInt32 (holdFrames)),
+                                                         runAndCount));
+
+        auto& whenNotSilent = context.allocate<AST::ScopeBlock>();
+        AST::addAssignment (whenNotSilent, *silentFrameCounter, context.allocator.createConstantInt32 (0));
+        whenNotSilent.addStatement (createRunCall());
+
+        block.addStatement (AST::createIfStatement (context, inputsAreSilent, whenSilent, whenNotSilent));
+    }
+
+private:
+    static bool isCheckableType (const AST::TypeBase& type)
+    {
+        if (type.isScalar())
+            return true;
+
+        if (type.isVector())
+            if (auto elementType = type.getArrayOrVectorElementType())
+                return elementType->isScalar();
+
+        return false;
+    }
+
+    static bool canCheckInputsForSilence (const AST::ProcessorBase& processor)
+    {
+        bool hasStreamInputs = false;
+
+        for (auto input : processor.getInputEndpoints (false))
+        {
+            if (input->isStream())
+            {
+                if (input->isArray() || ! isCheckableType (input->getSingleDataType().skipConstAndRefModifiers()))
+                    return false;
+
+                hasStreamInputs = true;
+            }
+        }
+
+        return hasStreamInputs;
+    }
+
+    static AST::ValueBase& createIsZero (const AST::ObjectContext& context, AST::ValueBase& value, const AST::TypeBase& type)
+    {
+        return AST::createBinaryOp (context, AST::BinaryOpTypeEnum::Enum::equals, value, type.allocateConstantValue (context));
+    }
+
+    static AST::ValueBase& createInputsAreSilentCheck (AST::ScopeBlock& block, std::string_view nodeName,
+                                                       const AST::ProcessorBase& processor, AST::ValueBase& ioVariable)
+    {
+        auto& context = block.context;
+        ptr<AST::ValueBase> result;
+
+        auto addCondition = [&] (AST::ValueBase& condition)
+        {
+            if (result == nullptr)
+                result = condition;
+            else
+                result = AST::createBinaryOp (context, AST::BinaryOpTypeEnum::Enum::logicalAnd, *result, condition);
+        };
+
+        for (auto input : processor.getInputEndpoints (false))
+        {
+            if (! input->isStream())
+                continue;
+
+            auto& type = input->getSingleDataType().skipConstAndRefModifiers();
+            auto memberName = StreamUtilities::getEndpointStateMemberName (input);
+
+            if (type.isVector())
+            {
+                auto& elementType = *type.getArrayOrVectorElementType();
+
+                for (int32_t i = 0; i < static_cast<int32_t> (type.getVectorSize()); ++i)
+                    addCondition (createIsZero (context, AST::createGetElement (context, AST::createGetStructMember (context, ioVariable, memberName), i),
+                                                elementType));
+            }
+            else
+            {
+                addCondition (createIsZero (context, AST::createGetStructMember (context, ioVariable, memberName), type));
+            }
+        }
+
+        CMAJ_ASSERT (result != nullptr);
+        return AST::createLocalVariableRef (block, std::string (nodeName) + "_inputsAreSilent", *result);
+    }
+};
 
 }
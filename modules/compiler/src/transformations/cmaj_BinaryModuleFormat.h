@@ -22,16 +22,21 @@ namespace cmaj::transformations
 
 /*
     Binary module format:
-        - 8 bytes header "Cmaj0001"
+        - 8 bytes header "Cmaj0001", or "Cmaj0L01" if the objects have source locations
         - 8 bytes xxHash64 of the rest of the file
         - compressed int: number of main top-level objects
         - Series of objects (first ones being the top-level objects), where an object is:
             - 1 byte: object class
             - compressed int: parent ID  (must be 0 for a top-level object)
+            - compressed int: source location (only if the header says there are locations),
+              which is 1 + the offset into the source file, or 0 if the object has no location
             - 1 byte: number of properties
             - ..list of stored properties
 
         Object IDs start from 1 and are sequential in the file
+
+    The source locations are only meaningful when the module is re-loaded alongside
+    exactly the same source text that it was parsed from, e.g. by a module cache.
 */
 
 static constexpr uint32_t hashOffset = 8;
@@ -48,9 +53,11 @@ struct BinaryModuleWriter
         data.reserve (8192);
     }
 
-    void store (const AST::ObjectRefVector<AST::ModuleBase>& mainObjects)
+    void store (const AST::ObjectRefVector<AST::ModuleBase>& mainObjects, std::string_view source = {})
     {
-        write (AST::getBinaryProgramHeader().data(), AST::getBinaryProgramHeader().length());
+        sourceText = source;
+        auto header = sourceText.empty() ? AST::getBinaryProgramHeader() : AST::getBinaryProgramWithLocationsHeader();
+        write (header.data(), header.length());
         writeZeros (8);  // space for the hash
         writeCompressedInt (static_cast<int64_t> (mainObjects.size()));
 
@@ -108,6 +115,9 @@ struct BinaryModuleWriter
         writeByte (o.getObjectClassID());
         writeCompressedInt (isMainObject ? 0 : addObjectToStore (o.context.parentScope.get()));
 
+        if (! sourceText.empty())
+            writeLocation (o.context.location);
+
         auto props = o.getPropertyList();
         uint32_t numActiveProps = 0;
 
@@ -187,6 +197,16 @@ struct BinaryModuleWriter
         CMAJ_ASSERT_FALSE;
     }
 
+    void writeLocation (CodeLocation location)
+    {
+        auto text = location.text.data();
+
+        if (text != nullptr && text >= sourceText.data() && text <= sourceText.data() + sourceText.length())
+            writeCompressedInt (1 + static_cast<int64_t> (text - sourceText.data()));
+        else
+            writeCompressedInt (0);
+    }
+
     void writeHash()
     {
         choc::hash::xxHash64 hash;
@@ -194,15 +214,16 @@ struct BinaryModuleWriter
         choc::memory::writeLittleEndian (data.data() + hashOffset, hash.getHash());
     }
 
+    std::string_view sourceText;
     std::vector<uint8_t> data;
     std::unordered_map<AST::Object*, uint32_t> objectIDs;
     std::vector<AST::Object*> objectsToStore;
 };
 
-std::vector<uint8_t> createBinaryModule (const AST::ObjectRefVector<AST::ModuleBase>& objects)
+std::vector<uint8_t> createBinaryModule (const AST::ObjectRefVector<AST::ModuleBase>& objects, std::string_view sourceText)
 {
     BinaryModuleWriter data;
-    data.store (objects);
+    data.store (objects, sourceText);
     return std::move (data.data);
 }
 
@@ -216,7 +237,8 @@ struct BinaryModuleReader
 
     void read (AST::Allocator& allocator,
                AST::ObjectRefVector<AST::ModuleBase>& results,
-               bool checkHashValidity)
+               bool checkHashValidity,
+               std::string_view sourceText = {})
     {
         objectsRead.reserve (numObjectsToReserve);
 
@@ -235,6 +257,9 @@ struct BinaryModuleReader
 
             AST::ObjectContext context { allocator, {}, nullptr };
 
+            if (hasLocations)
+                context.location = readLocation (sourceText);
+
             if (auto p = getObjectFromID (parentID))
                 context.parentScope = *p;
 
@@ -294,7 +319,13 @@ struct BinaryModuleReader
 
     bool readHeaderAndHash (bool checkHashValidity)
     {
-        if (size <= objectDataStart || std::string_view (reinterpret_cast<const char*> (data), hashOffset) != AST::getBinaryProgramHeader())
+        if (size <= objectDataStart)
+            return false;
+
+        auto header = std::string_view (reinterpret_cast<const char*> (data), hashOffset);
+        hasLocations = (header == AST::getBinaryProgramWithLocationsHeader());
+
+        if (! hasLocations && header != AST::getBinaryProgramHeader())
             return false;
 
         skip (8);
@@ -361,6 +392,23 @@ struct BinaryModuleReader
         return static_cast<uint32_t> (n);
     }
 
+    CodeLocation readLocation (std::string_view sourceText)
+    {
+        auto offset = readCompressedInt();
+
+        if (offset < 0)
+            throwError();
+
+        // if no source was provided, the locations are just skipped
+        if (offset == 0 || sourceText.empty())
+            return {};
+
+        if (static_cast<size_t> (offset - 1) > sourceText.length())
+            throwError();
+
+        return CodeLocation (choc::text::UTF8Pointer (sourceText.data() + (offset - 1)));
+    }
+
     std::string_view readZeroTerminatedString()
     {
         for (auto start = data;;)
@@ -592,6 +640,7 @@ struct BinaryModuleReader
 
     const uint8_t* data;
     size_t size;
+    bool hasLocations = false;
 
     struct ParentToResolve
     {
@@ -611,13 +660,13 @@ struct BinaryModuleReader
 
 //==============================================================================
 AST::ObjectRefVector<AST::ModuleBase> parseBinaryModule (AST::Allocator& allocator, const void* data, size_t size,
-                                                         bool checkHashValidity)
+                                                         bool checkHashValidity, std::string_view sourceText)
 {
     try
     {
         AST::ObjectRefVector<AST::ModuleBase> results;
         BinaryModuleReader reader (static_cast<const uint8_t*> (data), size);
-        reader.read (allocator, results, checkHashValidity);
+        reader.read (allocator, results, checkHashValidity, sourceText);
         return results;
     }
     catch (...)
@@ -133,16 +133,30 @@ inline AST::ProcessorBase& cloneProcessor (AST::ProcessorBase& originalProcessor
 }
 
 
+/// The frame index only needs to live in the state if output events are written, because
+/// they get timestamped from it. Otherwise, the block loop can use a local counter, which
+/// leaves it as a simple counted loop that the back-end is free to vectorise.
+inline bool canUseLocalFrameCounter (const AST::ProcessorBase& processor)
+{
+    for (auto output : processor.getOutputEndpoints (true))
+        if (output->isEvent())
+            return false;
+
+    return true;
+}
+
 inline AST::ProcessorBase& createBlockTransformProcessor (AST::ProcessorBase& originalProcessor, uint32_t maxBlockSize)
 {
     auto& blockProcessor = cloneProcessor (originalProcessor, originalProcessor.getName(), true);
     originalProcessor.setName (originalProcessor.getStringPool().get ("_" + std::string (originalProcessor.getName())));
 
     auto& stateType = EventHandlerUtilities::getOrCreateStateStructType (blockProcessor);
+    bool useLocalFrameCounter = canUseLocalFrameCounter (blockProcessor);
 
-    stateType.addMember (stateType.getStringPool().get (EventHandlerUtilities::getCurrentFrameStateMemberName()),
-                         blockProcessor.context.allocator.int32Type,
-                         0);
+    if (! useLocalFrameCounter)
+        stateType.addMember (stateType.getStringPool().get (EventHandlerUtilities::getCurrentFrameStateMemberName()),
+                             blockProcessor.context.allocator.int32Type,
+                             0);
 
     ValueStreamUtilities::addEventStreamSupport (blockProcessor);
 
@@ -195,8 +209,12 @@ inline AST::ProcessorBase& createBlockTransformProcessor (AST::ProcessorBase& or
 
         auto& mainBlock = *advance.getMainBlock();
 
-        auto& currentFrame = AST::createGetStructMember (blockProcessor, stateParam,
-                                                         EventHandlerUtilities::getCurrentFrameStateMemberName());
+        auto& currentFrame = useLocalFrameCounter
+                               ? static_cast<AST::ValueBase&> (AST::createLocalVariableRef (mainBlock, "_frame",
+                                                                                             blockProcessor.context.allocator.int32Type,
+                                                                                             blockProcessor.context.allocator.createConstantInt32 (0)))
+                               : static_cast<AST::ValueBase&> (AST::createGetStructMember (blockProcessor, stateParam,
+                                                                                             EventHandlerUtilities::getCurrentFrameStateMemberName()));
 
         auto& loop = advance.allocateChild<AST::LoopStatement>();
         auto& loopBlock = loop.allocateChild<AST::ScopeBlock>();
@@ -276,9 +294,10 @@ inline AST::ProcessorBase& createBlockTransformProcessor (AST::ProcessorBase& or
                                                                AST::createGetStructMember (mainBlock, AST::createGetStructMember (mainBlock.context, stateParam, "_state"), memberName)));
             }
 
-        mainBlock.addStatement (AST::createAssignment (mainBlock.context,
-                                                       currentFrame,
-                                                       mainBlock.context.allocator.createConstantInt32 (0)));
+        if (! useLocalFrameCounter)
+            mainBlock.addStatement (AST::createAssignment (mainBlock.context,
+                                                           currentFrame,
+                                                           mainBlock.context.allocator.createConstantInt32 (0)));
     }
 
     return blockProcessor;
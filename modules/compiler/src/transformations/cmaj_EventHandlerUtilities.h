@@ -150,6 +150,7 @@ struct ProcessorInfo
 
     bool isProcessorArray = false;
     bool usesProcessorId = false;
+    bool hasPerFrameMainFunction = false;
 };
 
 struct ProcessorInfoManager
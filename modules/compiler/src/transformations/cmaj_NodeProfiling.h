@@ -0,0 +1,115 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+#pragma once
+
+#include <chrono>
+
+namespace cmaj::transformations
+{
+
+//==============================================================================
+/// Used when the BuildSettings::shouldProfileNodes() flag is set, to wrap the run
+/// call of each node in the top-level graph with a pair of calls to a native timer,
+/// and add the elapsed time to a counter for that node.
+///
+/// The counters are the members of a struct which is held in a state variable
+/// called `_nodeProfile`, so that a performer can find them. Each member is named
+/// after its node, and holds the number of nanoseconds which the node has spent
+/// running since the processor was initialised.
+///
+/// The timer is bound as an external function, so this can only be used by back-ends
+/// which support those. If the flag isn't set, none of this code gets generated.
+struct NodeProfiling
+{
+    NodeProfiling (AST::Program& p, AST::ProcessorBase& g) : program (p), graph (g) {}
+
+    static constexpr std::string_view stateMemberName = "_nodeProfile";
+
+    /// Creates a block containing the statements added by the addStatements functor,
+    /// followed by an update of the given node's counter.
+    template <typename AddStatements>
+    void addTimedBlock (AST::ScopeBlock& block, std::string_view nodeName, AddStatements&& addStatements)
+    {
+        auto& context = block.context;
+        auto& int64Type = context.allocator.int64Type;
+        auto& timer = getTimerFunction();
+
+        auto& timedBlock = block.allocateChild<AST::ScopeBlock>();
+        block.addStatement (timedBlock);
+
+        auto& startTime = AST::createLocalVariable (timedBlock, "_startTime", int64Type, AST::createFunctionCall (context, timer));
+
+        addStatements (timedBlock);
+
+        auto& counters = getCounters();
+
+        if (! counters.hasMember (nodeName))
+            counters.addMember (nodeName, int64Type);
+
+        auto& counter = AST::createGetStructMember (context, AST::createVariableReference (context, *profileVariable), nodeName);
+
+        auto& elapsed = AST::createSubtract (context, AST::createFunctionCall (context, timer),
+                                             AST::createVariableReference (context, startTime));
+
+        AST::addAssignment (timedBlock, counter,
+                            AST::createAdd (context, AST::createGetStructMember (context, AST::createVariableReference (context, *profileVariable), nodeName),
+                                            elapsed));
+    }
+
+    static int64_t readTimer()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    AST::Program& program;
+    AST::ProcessorBase& graph;
+    ptr<AST::StructType> counterStruct;
+    ptr<AST::VariableDeclaration> profileVariable;
+    ptr<AST::Function> timerFunction;
+
+    AST::StructType& getCounters()
+    {
+        if (counterStruct == nullptr)
+        {
+            counterStruct = AST::createStruct (graph, "_NodeProfile");
+            profileVariable = AST::createStateVariable (graph, stateMemberName, *counterStruct, {});
+        }
+
+        return *counterStruct;
+    }
+
+    AST::Function& getTimerFunction()
+    {
+        if (timerFunction == nullptr)
+        {
+            timerFunction = graph.allocateChild<AST::Function>();
+            timerFunction->name = graph.getStringPool().get ("_readNodeProfileTimer");
+            timerFunction->returnType.referTo (graph.context.allocator.int64Type);
+            timerFunction->isExternal = true;
+            graph.functions.addReference (*timerFunction);
+
+            program.externalFunctionManager.addFunctionWithImplementation (*timerFunction, reinterpret_cast<void*> (readTimer));
+        }
+
+        return *timerFunction;
+    }
+};
+
+}
@@ -0,0 +1,238 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+namespace cmaj::transformations
+{
+
+//==============================================================================
+/// Re-orders the members of each processor's state struct so that the small
+/// values which get touched every frame sit together at the start of the struct,
+/// and anything bigger than a cache line (delay buffers, lookup tables, event
+/// lists, etc.) is pushed to the end.
+///
+/// The state structs of nodes which are instantiated as arrays are also padded to
+/// a whole number of cache lines, so that neighbouring instances don't share lines.
+///
+/// The AST doesn't know the exact layout that a backend will choose, so sizes and
+/// alignments here are estimates based on natural alignment.
+///
+/// Returns a description of the layout that was chosen, for the build log.
+struct OptimiseStateLayout
+{
+    static constexpr size_t cacheLineSize = 64;
+
+    std::string run (AST::Program& program)
+    {
+        for (auto& p : program.getAllProcessors())
+            if (auto stateStruct = p->structures.findObjectWithName (p->getStrings().stateStructName))
+                layOutStruct (*stateStruct->getAsStructType());
+
+        return choc::text::joinStrings (descriptions, "\n");
+    }
+
+private:
+    std::unordered_set<const AST::StructType*> structsDone, structsPadded;
+    std::vector<std::string> descriptions;
+
+    struct Member
+    {
+        ref<AST::Property> name, type;
+        size_t size, alignment;
+        bool isHot;
+    };
+
+    static bool isStateStruct (const AST::StructType& s)
+    {
+        return s.name.get() == s.getStrings().stateStructName;
+    }
+
+    static size_t getSize (const AST::TypeBase& t)
+    {
+        return t.skipConstAndRefModifiers().getPackedStorageSize();
+    }
+
+    static size_t getAlignment (const AST::TypeBase& t)
+    {
+        auto& type = t.skipConstAndRefModifiers();
+
+        if (type.isSlice())
+            return 8;
+
+        if (type.isVector())
+        {
+            size_t alignment = 1;
+
+            while (alignment < type.getPackedStorageSize() && alignment < cacheLineSize)
+                alignment *= 2;
+
+            return alignment;
+        }
+
+        if (type.isArray())
+            return getAlignment (*type.getArrayOrVectorElementType());
+
+        if (auto s = type.getAsStructType())
+        {
+            size_t alignment = 1;
+
+            for (size_t i = 0; i < s->memberTypes.size(); ++i)
+                alignment = std::max (alignment, getAlignment (s->getMemberType (i)));
+
+            return alignment;
+        }
+
+        return std::max (static_cast<size_t> (1), type.getPackedStorageSize());
+    }
+
+    static size_t roundUp (size_t size, size_t alignment)
+    {
+        return ((size + alignment - 1) / alignment) * alignment;
+    }
+
+    static size_t getEstimatedNativeSize (const AST::StructType& s)
+    {
+        return roundUp (s.getPackedStorageSize(), getAlignment (s));
+    }
+
+    static ptr<AST::StructType> getNestedStateStruct (AST::TypeBase& t)
+    {
+        if (auto s = t.skipConstAndRefModifiers().getAsStructType())
+            if (isStateStruct (*s))
+                return *s;
+
+        return {};
+    }
+
+    void layOutStruct (AST::StructType& s)
+    {
+        if (! structsDone.insert (std::addressof (s)).second)
+            return;
+
+        // nested node states need to be laid out first, as their sizes affect ours
+        for (size_t i = 0; i < s.memberTypes.size(); ++i)
+        {
+            auto& memberType = AST::castToTypeBaseRef (s.memberTypes[i]).skipConstAndRefModifiers();
+
+            if (auto nested = getNestedStateStruct (memberType))
+            {
+                layOutStruct (*nested);
+            }
+            else if (auto array = memberType.getAsArrayType(); array != nullptr && array->isFixedSizeArray())
+            {
+                if (auto element = getNestedStateStruct (array->getInnermostElementTypeRef()))
+                {
+                    layOutStruct (*element);
+                    padToCacheLine (*element);
+                }
+            }
+        }
+
+        std::vector<Member> members;
+
+        for (size_t i = 0; i < s.memberNames.size(); ++i)
+        {
+            auto& type = s.getMemberType (i);
+            auto size = getSize (type);
+
+            members.push_back ({ s.memberNames[i], s.memberTypes[i], size, getAlignment (type), size <= cacheLineSize });
+        }
+
+        // hot members come first, in order of decreasing alignment to avoid padding gaps,
+        // and the cold ones follow in their original order
+        std::stable_sort (members.begin(), members.end(), [] (const Member& a, const Member& b)
+        {
+            if (a.isHot != b.isHot)
+                return a.isHot;
+
+            return a.isHot && a.alignment > b.alignment;
+        });
+
+        // N.B. this just permutes the existing properties, because ListProperty::set (list)
+        // would reset them
+        for (size_t i = 0; i < members.size(); ++i)
+        {
+            s.memberNames.set (members[i].name.get(), i);
+            s.memberTypes.set (members[i].type.get(), i);
+        }
+
+        descriptions.push_back (describeLayout (s, members));
+    }
+
+    void padToCacheLine (AST::StructType& s)
+    {
+        if (! structsPadded.insert (std::addressof (s)).second)
+            return;
+
+        auto size = getEstimatedNativeSize (s);
+
+        // padding small structs would waste more cache than it saves
+        if (size < cacheLineSize)
+            return;
+
+        auto padding = roundUp (size, cacheLineSize) - size;
+        auto& int32Type = s.context.allocator.int32Type;
+
+        if (padding == 0 || (padding % int32Type.getPackedStorageSize()) != 0)
+            return;
+
+        auto numElements = static_cast<int32_t> (padding / int32Type.getPackedStorageSize());
+        s.addMember ("_cacheLinePadding", AST::createArrayOfType (s, int32Type, numElements));
+
+        descriptions.push_back ("  " + getProcessorName (s) + " instances padded from " + std::to_string (size)
+                                  + " to " + std::to_string (size + padding) + " bytes");
+    }
+
+    static std::string getProcessorName (const AST::StructType& s)
+    {
+        if (auto p = s.findParentOfType<AST::ProcessorBase>())
+            return p->getFullyQualifiedReadableName();
+
+        return std::string (s.name.get());
+    }
+
+    static std::string describeLayout (const AST::StructType& s, const std::vector<Member>& members)
+    {
+        std::string hot, cold;
+        size_t hotSize = 0;
+
+        for (auto& m : members)
+        {
+            auto& list = m.isHot ? hot : cold;
+
+            if (! list.empty())
+                list += ", ";
+
+            list += std::string (m.name->getAsStringProperty()->get()) + " (" + std::to_string (m.size) + ")";
+
+            if (m.isHot)
+                hotSize = roundUp (hotSize, m.alignment) + m.size;
+        }
+
+        return "State layout for " + getProcessorName (s) + ": " + std::to_string (getEstimatedNativeSize (s)) + " bytes, "
+                 + std::to_string (roundUp (hotSize, cacheLineSize) / cacheLineSize) + " hot cache line(s)\n"
+                 + "  hot: " + (hot.empty() ? std::string ("-") : hot) + "\n"
+                 + "  cold: " + (cold.empty() ? std::string ("-") : cold);
+    }
+};
+
+inline std::string optimiseStateLayout (AST::Program& program)
+{
+    return OptimiseStateLayout().run (program);
+}
+
+}
@@ -63,6 +63,20 @@ struct OversamplingTransformation
             return arraySize ? *arraySize : 1;
         }
 
+        AST::PooledString getFrameTypeName (const std::string& prefix, const std::string& suffix = {})
+        {
+            CMAJ_ASSERT (frameType.isPrimitive() || frameType.isVector());
+
+            std::string name = prefix;
+
+            if (auto vectorType = frameType.getAsVectorType())
+                name = name + std::string (vectorType->getElementType().getName()) + "_" + std::to_string (vectorType->getVectorSize());
+            else
+                name = name + std::string (frameType.getName());
+
+            return processor.getStringPool().get (name + suffix);
+        }
+
         AST::ProcessorBase& processor;
         const AST::EndpointDeclaration& endpoint;
         const int32_t factor;
@@ -191,20 +205,6 @@ struct OversamplingTransformation
             }
         }
 
-        AST::PooledString getFrameTypeName (const std::string& prefix)
-        {
-            CMAJ_ASSERT (frameType.isPrimitive() || frameType.isVector());
-
-            std::string name = prefix;
-
-            if (auto vectorType = frameType.getAsVectorType())
-                name = name + std::string (vectorType->getElementType().getName()) + "_" + std::to_string (vectorType->getVectorSize());
-            else
-                name = name + std::string (frameType.getName());
-
-            return processor.getStringPool().get (name);
-        }
-
         AST::TypeBase& getOrCreateSincStruct()
         {
             auto typeName = getFrameTypeName ("_Sinc_");
@@ -481,6 +481,337 @@ struct OversamplingTransformation
         }
     };
 
+    //==============================================================================
+    /// Resamples using the cascade of linear-phase half-band FIR filters described by
+    /// HalfBandFilterCascade. Each stage is split into its two polyphase branches, so
+    /// only the non-zero taps are evaluated. Unlike the sinc filters, the group delay is
+    /// constant, and the graph includes it in its latency.
+    struct PolyphaseBase : public Interpolator
+    {
+        PolyphaseBase (AST::ProcessorBase& p, const AST::EndpointDeclaration& e, int32_t f) : Interpolator (p, e, f)
+        {
+            CMAJ_ASSERT (frameType.isFloatOrVectorOfFloat());
+
+            numStages = HalfBandFilterCascade::getNumStages (f);
+
+            auto& stateType = EventHandlerUtilities::getOrCreateStateStructType (processor);
+
+            stateType.addMember (getEndpointStateValuesName(), convertTypeWithArraySize (AST::createArrayOfType (processor, frameType, factor)));
+            stateType.addMember (getIndexStateMemberName(), p.context.allocator.createInt32Type());
+
+            for (int stage = 0; stage < numStages; ++stage)
+                stateType.addMember (getFilterStateMemberName (stage), convertTypeWithArraySize (getOrCreateFilterStruct (stage)));
+        }
+
+        void populateReset (AST::ScopeBlock& block, AST::ValueBase& stateParam) override
+        {
+            for (int stage = 0; stage < numStages; ++stage)
+            {
+                for (int i = 0; i < getArrayElements(); i++)
+                {
+                    auto& zeroValue = block.context.allocate<AST::ConstantAggregate>();
+                    zeroValue.type.createReferenceTo (getOrCreateFilterStruct (stage));
+
+                    AST::addAssignment (block, getFilterState (block, stateParam, stage, i), zeroValue);
+                }
+            }
+        }
+
+    protected:
+        int numStages;
+
+        std::string getIndexStateMemberName() const
+        {
+            return getEndpointStateValuesName() + "_index";
+        }
+
+        std::string getFilterStateMemberName (int stage) const
+        {
+            return getEndpointStateValuesName() + "_filter" + std::to_string (stage);
+        }
+
+        AST::ValueBase& getFilterState (AST::ScopeBlock& block, AST::ValueBase& stateParam, int stage, int arrayIndex)
+        {
+            return getArrayElement (block, AST::createGetStructMember (block.context, stateParam, getFilterStateMemberName (stage)), arrayIndex);
+        }
+
+        AST::ValueBase& getFrames (AST::ScopeBlock& block, AST::ValueBase& stateParam, int arrayIndex)
+        {
+            return getArrayElement (block, AST::createGetStructMember (block.context, stateParam, getEndpointStateValuesName()), arrayIndex);
+        }
+
+        // Each stage's filter keeps its recent input in a buffer which is twice as long as it
+        // needs to be, with every value written to both halves. That way, the last 2K values
+        // can always be read with a constant offset from the write position, without wrapping.
+        AST::TypeBase& getOrCreateFilterStruct (int stage)
+        {
+            auto numCoeffs = HalfBandFilterCascade::getNumCoefficients (stage);
+            auto typeName = getFrameTypeName ("_HalfBand_", "_" + std::to_string (numCoeffs));
+
+            if (auto t = processor.findStruct (typeName))
+                return *t;
+
+            auto& t = AST::createStruct (processor, typeName);
+
+            t.addMember ("history", AST::createArrayOfType (processor, frameType, 4 * numCoeffs));
+            t.addMember ("delay", AST::createArrayOfType (processor, frameType, 2 * numCoeffs));
+            t.addMember ("pos", processor.context.allocator.createInt32Type());
+            t.addMember ("delayPos", processor.context.allocator.createInt32Type());
+
+            return t;
+        }
+
+        AST::ValueBase& createCoefficient (const AST::ObjectContext& context, double value)
+        {
+            if (frameType.isScalar64())
+                return context.allocator.createConstantFloat64 (value);
+
+            return context.allocator.createConstantFloat32 (static_cast<float> (value));
+        }
+
+        static AST::ValueBase& getBufferElement (AST::ScopeBlock& block, AST::ValueBase& filter, std::string_view buffer,
+                                                 AST::ValueBase& position, int32_t offset)
+        {
+            auto& index = AST::createAdd (block.context, position, block.context.allocator.createConstantInt32 (offset));
+            return AST::createGetElement (block.context, AST::createGetStructMember (block.context, filter, buffer), index);
+        }
+
+        static void pushValue (AST::ScopeBlock& block, AST::ValueBase& filter, std::string_view buffer,
+                               std::string_view position, int32_t length, const AST::VariableRefGenerator& value)
+        {
+            AST::addAssignment (block, getBufferElement (block, filter, buffer, AST::createGetStructMember (block.context, filter, position), 0), value);
+            AST::addAssignment (block, getBufferElement (block, filter, buffer, AST::createGetStructMember (block.context, filter, position), length), value);
+        }
+
+        static void advancePosition (AST::ScopeBlock& block, AST::ValueBase& filter, std::string_view position, int32_t length)
+        {
+            block.addStatement (AST::createPreInc (block.context, AST::createGetStructMember (block.context, filter, position)));
+
+            block.addStatement (AST::createIfStatement (block.context,
+                                                        AST::createBinaryOp (block.context,
+                                                                             AST::BinaryOpTypeEnum::Enum::equals,
+                                                                             AST::createGetStructMember (block.context, filter, position),
+                                                                             block.context.allocator.createConstantInt32 (length)),
+                                                        AST::createAssignment (block.context,
+                                                                               AST::createGetStructMember (block.context, filter, position),
+                                                                               block.context.allocator.createConstantInt32 (0))));
+        }
+
+        // Applies the branch of the filter which contains all the non-zero taps apart from the
+        // centre one, to the last 2K values in the history buffer. The taps are symmetrical, so
+        // the pairs of values which share a coefficient are added before multiplying.
+        AST::ValueBase& createFIRSum (AST::ScopeBlock& block, AST::ValueBase& filter, int stage)
+        {
+            auto coeffs = HalfBandFilterCascade::getCoefficients (stage);
+            auto numCoeffs = static_cast<int32_t> (coeffs.size());
+
+            auto& newest = AST::createLocalVariable (block, "newest", block.context.allocator.int32Type,
+                                                     AST::createAdd (block.context,
+                                                                     AST::createGetStructMember (block.context, filter, "pos"),
+                                                                     block.context.allocator.createConstantInt32 (2 * numCoeffs)));
+            ptr<AST::ValueBase> sum;
+
+            for (int32_t i = 0; i < numCoeffs; ++i)
+            {
+                auto& pair = AST::createAdd (block.context,
+                                             getBufferElement (block, filter, "history", AST::createVariableReference (block.context, newest), -i),
+                                             getBufferElement (block, filter, "history", AST::createVariableReference (block.context, newest), i + 1 - 2 * numCoeffs));
+
+                AST::ValueBase& term = AST::createMultiply (block.context, pair, createCoefficient (block.context, coeffs[static_cast<size_t> (i)]));
+
+                if (sum == nullptr)
+                    sum = term;
+                else
+                    sum = AST::createAdd (block.context, *sum, term);
+            }
+
+            return *sum;
+        }
+    };
+
+    //==============================================================================
+    struct PolyphaseUpsampler   : public PolyphaseBase
+    {
+        PolyphaseUpsampler (AST::ProcessorBase& p, const AST::EndpointDeclaration& e, int32_t f) : PolyphaseBase (p, e, f)
+        {
+            for (int stage = 0; stage < numStages; ++stage)
+                interpolateFunctions.push_back (getOrCreateInterpolateFn (stage));
+        }
+
+        void addInputValue (AST::ScopeBlock& block, AST::ValueBase& stateParam, AST::ValueBase& source) override
+        {
+            int step = factor / 2;
+
+            for (int stage = 0; stage < numStages; ++stage)
+            {
+                for (int frame = 0; frame < factor; frame += step * 2)
+                {
+                    for (int i = 0; i < getArrayElements(); i++)
+                    {
+                        auto& frames = getFrames (block, stateParam, i);
+                        auto& target1 = AST::createGetElement (block.context, frames, frame);
+                        auto& target2 = AST::createGetElement (block.context, frames, frame + step);
+
+                        block.addStatement (AST::createFunctionCall (block.context,
+                                                                     *interpolateFunctions[static_cast<size_t> (stage)],
+                                                                     getFilterState (block, stateParam, stage, i),
+                                                                     (stage == 0) ? getArrayElement (block, source, i) : target1,
+                                                                     target1,
+                                                                     target2));
+                    }
+                }
+
+                step /= 2;
+            }
+
+            AST::addAssignment (block,
+                                AST::createGetStructMember (block.context, stateParam, getIndexStateMemberName()),
+                                block.context.allocator.createConstantInt32 (0));
+        }
+
+        void getInterpolatedOutputValue (AST::ScopeBlock& block, AST::ValueBase& stateParam, AST::ValueBase& target) override
+        {
+            for (int i = 0; i < getArrayElements(); i++)
+            {
+                AST::addAssignment (block,
+                                    getArrayElement (block, target, i),
+                                    AST::createGetElement (block.context,
+                                                           getFrames (block, stateParam, i),
+                                                           AST::createGetStructMember (block.context, stateParam, getIndexStateMemberName())));
+            }
+
+            block.addStatement (AST::createPreInc (block.context,
+                                                   AST::createGetStructMember (block.context, stateParam, getIndexStateMemberName())));
+        }
+
+    private:
+        AST::ObjectRefVector<AST::Function> interpolateFunctions;
+
+        // For an input x[n], this produces the pair of output frames y[2n - 1] and y[2n].
+        // The odd frame only involves the centre tap, so it's just x[n - K].
+        AST::Function& getOrCreateInterpolateFn (int stage)
+        {
+            auto numCoeffs = HalfBandFilterCascade::getNumCoefficients (stage);
+            auto functionName = getFrameTypeName ("_HalfBandInterpolate_", "_" + std::to_string (numCoeffs));
+
+            if (auto fn = processor.findFunction (functionName, 4))
+                return *fn;
+
+            auto& fn = AST::createFunctionInModule (processor, processor.context.allocator.createVoidType(), functionName);
+
+            auto filterParam = AST::addFunctionParameter (fn, getOrCreateFilterStruct (stage), "filter", true, false);
+            auto inParam     = AST::addFunctionParameter (fn, frameType, "in", false, false);
+            auto out1Param   = AST::addFunctionParameter (fn, frameType, "out1", true, false);
+            auto out2Param   = AST::addFunctionParameter (fn, frameType, "out2", true, false);
+
+            auto& mainBlock = *fn.getMainBlock();
+            AST::ValueBase& filter = filterParam;
+
+            pushValue (mainBlock, filter, "history", "pos", 2 * numCoeffs, inParam);
+
+            AST::addAssignment (mainBlock, out1Param, getBufferElement (mainBlock, filter, "history",
+                                                                        AST::createGetStructMember (mainBlock.context, filter, "pos"),
+                                                                        numCoeffs));
+            AST::addAssignment (mainBlock, out2Param, createFIRSum (mainBlock, filter, stage));
+
+            advancePosition (mainBlock, filter, "pos", 2 * numCoeffs);
+            return fn;
+        }
+    };
+
+    //==============================================================================
+    struct PolyphaseDownsampler   : public PolyphaseBase
+    {
+        PolyphaseDownsampler (AST::ProcessorBase& p, const AST::EndpointDeclaration& e, int32_t f) : PolyphaseBase (p, e, f)
+        {
+            for (int stage = 0; stage < numStages; ++stage)
+                decimateFunctions.push_back (getOrCreateDecimateFn (stage));
+        }
+
+        void addInputValue (AST::ScopeBlock& block, AST::ValueBase& stateParam, AST::ValueBase& source) override
+        {
+            for (int i = 0; i < getArrayElements(); i++)
+            {
+                AST::addAssignment (block,
+                                    AST::createGetElement (block.context,
+                                                           getFrames (block, stateParam, i),
+                                                           AST::createGetStructMember (block.context, stateParam, getIndexStateMemberName())),
+                                    getArrayElement (block, source, i));
+            }
+
+            block.addStatement (AST::createPreInc (block.context,
+                                                   AST::createGetStructMember (block.context, stateParam, getIndexStateMemberName())));
+        }
+
+        void getInterpolatedOutputValue (AST::ScopeBlock& block, AST::ValueBase& stateParam, AST::ValueBase& target) override
+        {
+            int step = 1;
+
+            // The highest-rate stage runs first, so the stages are visited in reverse
+            for (int stage = numStages - 1; stage >= 0; --stage)
+            {
+                for (int frame = 0; frame < factor; frame += step * 2)
+                {
+                    for (int i = 0; i < getArrayElements(); i++)
+                    {
+                        auto& frames = getFrames (block, stateParam, i);
+                        auto& source1 = AST::createGetElement (block.context, frames, frame);
+                        auto& source2 = AST::createGetElement (block.context, frames, frame + step);
+
+                        block.addStatement (AST::createFunctionCall (block.context,
+                                                                     *decimateFunctions[static_cast<size_t> (stage)],
+                                                                     getFilterState (block, stateParam, stage, i),
+                                                                     source1,
+                                                                     source2,
+                                                                     (stage == 0) ? getArrayElement (block, target, i) : source1));
+                    }
+                }
+
+                step *= 2;
+            }
+
+            AST::addAssignment (block,
+                                AST::createGetStructMember (block.context, stateParam, getIndexStateMemberName()),
+                                block.context.allocator.createConstantInt32 (0));
+        }
+
+    private:
+        AST::ObjectRefVector<AST::Function> decimateFunctions;
+
+        // Takes the input frames u[2n] and u[2n + 1], and produces the output frame z[n].
+        // The even frames only meet the centre tap, so they just need delaying by K - 1.
+        AST::Function& getOrCreateDecimateFn (int stage)
+        {
+            auto numCoeffs = HalfBandFilterCascade::getNumCoefficients (stage);
+            auto functionName = getFrameTypeName ("_HalfBandDecimate_", "_" + std::to_string (numCoeffs));
+
+            if (auto fn = processor.findFunction (functionName, 4))
+                return *fn;
+
+            auto& fn = AST::createFunctionInModule (processor, processor.context.allocator.createVoidType(), functionName);
+
+            auto filterParam = AST::addFunctionParameter (fn, getOrCreateFilterStruct (stage), "filter", true, false);
+            auto in1Param    = AST::addFunctionParameter (fn, frameType, "in1", false, false);
+            auto in2Param    = AST::addFunctionParameter (fn, frameType, "in2", false, false);
+            auto outParam    = AST::addFunctionParameter (fn, frameType, "out", true, false);
+
+            auto& mainBlock = *fn.getMainBlock();
+            AST::ValueBase& filter = filterParam;
+
+            pushValue (mainBlock, filter, "history", "pos", 2 * numCoeffs, in2Param);
+            pushValue (mainBlock, filter, "delay", "delayPos", numCoeffs, in1Param);
+
+            auto& delayed = getBufferElement (mainBlock, filter, "delay", AST::createGetStructMember (mainBlock.context, filter, "delayPos"), 1);
+            auto& sum = AST::createAdd (mainBlock.context, delayed, createFIRSum (mainBlock, filter, stage));
+
+            AST::addAssignment (mainBlock, outParam, AST::createMultiply (mainBlock.context, sum, createCoefficient (mainBlock.context, 0.5)));
+
+            advancePosition (mainBlock, filter, "pos", 2 * numCoeffs);
+            advancePosition (mainBlock, filter, "delayPos", numCoeffs);
+            return fn;
+        }
+    };
+
     //==============================================================================
     static std::unique_ptr<Interpolator> buildInterpolator (AST::ProcessorBase& processor,
                                                             AST::EndpointDeclaration& endpoint,
@@ -503,6 +834,8 @@ struct OversamplingTransformation
                 case AST::InterpolationTypeEnum::Enum::best:
                 case AST::InterpolationTypeEnum::Enum::sinc:    return std::make_unique<SincUpsampler> (processor, endpoint, oversampleFactor);
 
+                case AST::InterpolationTypeEnum::Enum::polyphase:   return std::make_unique<PolyphaseUpsampler> (processor, endpoint, oversampleFactor);
+
                 default:
                     CMAJ_ASSERT_FALSE;
             }
@@ -519,6 +852,8 @@ struct OversamplingTransformation
                 case AST::InterpolationTypeEnum::Enum::best:
                 case AST::InterpolationTypeEnum::Enum::sinc:    return std::make_unique<SincDownsampler> (processor, endpoint, undersampleFactor);
 
+                case AST::InterpolationTypeEnum::Enum::polyphase:   return std::make_unique<PolyphaseDownsampler> (processor, endpoint, undersampleFactor);
+
                 default:
                     CMAJ_ASSERT_FALSE;
             }
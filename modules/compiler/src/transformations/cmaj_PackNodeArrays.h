@@ -0,0 +1,536 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+namespace cmaj::transformations
+{
+
+//==============================================================================
+/// Converts node arrays (e.g. `voices = Voice[16]`) from an array of per-instance
+/// state and IO structs into a single struct whose members are arrays with one
+/// element per instance.
+///
+/// The functions which take a packed struct get an extra int32 "lane" parameter
+/// for each one, and every member access `s.x` becomes `s.x[lane]`. Because each
+/// member of the instances is then contiguous, the loop which runs the instances
+/// reads and writes them with a unit stride, which the backends' vectorisers can
+/// turn into SIMD operations across voices. Event handlers still run separately
+/// for each lane, so instances that diverge behave exactly as before.
+///
+/// This is only done when every use of the structs involved is a simple member
+/// access or a pass-by-reference to a function, so anything more exotic (copying
+/// a whole instance, returning one, etc.) just leaves that node array alone.
+///
+/// Returns a description of the arrays that were packed, for the build log.
+struct PackNodeArrays
+{
+    PackNodeArrays (AST::Program& p) : program (p) {}
+
+    std::string run()
+    {
+        std::unordered_set<const AST::StructType*> attempted;
+
+        for (;;)
+        {
+            findLiveObjects();
+
+            if (! findNextCandidate (attempted))
+                break;
+
+            attempted.insert (rootStruct.get());
+
+            if (canPack())
+                pack();
+        }
+
+        return choc::text::joinStrings (descriptions, "\n");
+    }
+
+private:
+    enum class Kind { other, packed, instanceArray, unsupported };
+
+    struct Lane
+    {
+        ptr<const AST::VariableDeclaration> parameter;
+        ptr<AST::Object> index;
+    };
+
+    struct LoweredValue
+    {
+        ref<AST::ValueBase> base;
+        Lane lane;
+    };
+
+    AST::Program& program;
+    std::vector<std::string> descriptions;
+
+    std::vector<ref<AST::Object>> liveObjects;
+    std::unordered_set<const AST::Object*> liveObjectSet;
+
+    ptr<const AST::StructType> rootStruct;
+    AST::ArraySize numInstances = 0;
+    std::unordered_set<const AST::StructType*> packedStructs;
+
+    std::vector<ref<AST::StructType>> structsToPack;
+    std::vector<std::pair<ref<AST::StructType>, size_t>> instanceArrayMembers;
+    std::vector<ref<AST::VariableDeclaration>> instanceArrayVariables;
+    std::vector<ref<AST::Function>> functionsToExtend;
+    std::vector<ref<AST::GetStructMember>> memberAccesses;
+    std::vector<ref<AST::FunctionCall>> calls;
+
+    std::unordered_map<const AST::VariableDeclaration*, ptr<const AST::VariableDeclaration>> laneParameters;
+    std::unordered_map<const AST::Object*, LoweredValue> loweredValues;
+
+    //==============================================================================
+    void findLiveObjects()
+    {
+        struct LiveObjectFinder  : public AST::NonParameterisedObjectVisitor
+        {
+            using super = AST::NonParameterisedObjectVisitor;
+
+            LiveObjectFinder (PackNodeArrays& o) : super (o.program.allocator), owner (o) {}
+
+            void visitObject (AST::Object& o) override
+            {
+                if (owner.liveObjectSet.insert (std::addressof (o)).second)
+                    owner.liveObjects.push_back (o);
+
+                super::visitObject (o);
+            }
+
+            PackNodeArrays& owner;
+        };
+
+        liveObjects.clear();
+        liveObjectSet.clear();
+        LiveObjectFinder (*this).visitObject (program.rootNamespace);
+    }
+
+    static bool isProcessorStruct (const AST::StructType& s)
+    {
+        return (s.name.get() == s.getStrings().stateStructName || s.name.get() == s.getStrings().ioStructName)
+                && s.findParentOfType<AST::ProcessorBase>() != nullptr;
+    }
+
+    static ptr<const AST::StructType> getNodeArrayElementStruct (const AST::TypeBase& type)
+    {
+        if (auto a = type.skipConstAndRefModifiers().getAsArrayType())
+            if (a->isFixedSizeArray() && a->getNumDimensions() == 1 && a->resolveSize() > 1)
+                if (auto s = a->getInnermostElementTypeRef().skipConstAndRefModifiers().getAsStructType())
+                    if (isProcessorStruct (*s))
+                        return *s;
+
+        return {};
+    }
+
+    bool findNextCandidate (const std::unordered_set<const AST::StructType*>& attempted)
+    {
+        auto tryType = [&] (ptr<const AST::TypeBase> type)
+        {
+            if (type != nullptr)
+            {
+                if (auto s = getNodeArrayElementStruct (*type))
+                {
+                    if (attempted.find (s.get()) == attempted.end())
+                    {
+                        rootStruct = s;
+                        numInstances = type->skipConstAndRefModifiers().getAsArrayType()->resolveSize();
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        };
+
+        for (auto& o : liveObjects)
+        {
+            if (auto s = o->getAsStructType())
+            {
+                for (size_t i = 0; i < s->memberTypes.size(); ++i)
+                    if (tryType (s->getMemberType (i)))
+                        return true;
+            }
+            else if (auto v = o->getAsVariableDeclaration())
+            {
+                if (tryType (v->getType()))
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
+    void addPackedStruct (const AST::StructType& s)
+    {
+        if (packedStructs.insert (std::addressof (s)).second)
+        {
+            for (size_t i = 0; i < s.memberTypes.size(); ++i)
+                if (auto member = s.getMemberType (i).skipConstAndRefModifiers().getAsStructType())
+                    if (isProcessorStruct (*member))
+                        addPackedStruct (*member);
+        }
+    }
+
+    Kind getKind (ptr<const AST::TypeBase> type) const
+    {
+        return type != nullptr ? getKind (*type) : Kind::other;
+    }
+
+    Kind getKind (const AST::TypeBase& type) const
+    {
+        auto& t = type.skipConstAndRefModifiers();
+
+        if (auto s = t.getAsStructType())
+            return packedStructs.find (s) != packedStructs.end() ? Kind::packed : Kind::other;
+
+        if (auto a = t.getAsArrayType())
+        {
+            if (auto element = a->getInnermostElementTypeRef().skipConstAndRefModifiers().getAsStructType())
+            {
+                if (element == rootStruct.get() && a->isFixedSizeArray()
+                     && a->getNumDimensions() == 1 && a->resolveSize() == numInstances)
+                    return Kind::instanceArray;
+
+                if (packedStructs.find (element) != packedStructs.end())
+                    return Kind::unsupported;
+            }
+        }
+
+        return Kind::other;
+    }
+
+    //==============================================================================
+    bool canPack()
+    {
+        packedStructs.clear();
+        structsToPack.clear();
+        instanceArrayMembers.clear();
+        instanceArrayVariables.clear();
+        functionsToExtend.clear();
+        memberAccesses.clear();
+        calls.clear();
+        laneParameters.clear();
+        loweredValues.clear();
+
+        addPackedStruct (*rootStruct);
+
+        for (auto& o : liveObjects)
+        {
+            if (auto s = o->getAsStructType())
+            {
+                if (! checkStruct (*s))
+                    return false;
+            }
+            else if (auto v = o->getAsVariableDeclaration())
+            {
+                if (! checkVariable (*v))
+                    return false;
+            }
+            else if (auto f = o->getAsFunction())
+            {
+                for (auto& param : f->iterateParameters())
+                {
+                    if (getKind (param.getType()) == Kind::packed)
+                    {
+                        functionsToExtend.push_back (*f);
+                        break;
+                    }
+                }
+            }
+            else if (auto value = o->getAsValueBase())
+            {
+                if (! checkValue (*value))
+                    return false;
+            }
+        }
+
+        for (auto& c : calls)
+            if (! checkCallArguments (c))
+                return false;
+
+        return ! memberAccesses.empty();
+    }
+
+    bool checkStruct (AST::StructType& s)
+    {
+        bool isPacked = packedStructs.find (std::addressof (s)) != packedStructs.end();
+
+        if (isPacked)
+            structsToPack.push_back (s);
+
+        for (size_t i = 0; i < s.memberTypes.size(); ++i)
+        {
+            auto& memberType = s.getMemberType (i);
+            auto kind = getKind (memberType);
+
+            if (kind == Kind::unsupported)
+                return false;
+
+            if (kind == Kind::instanceArray)
+            {
+                if (isPacked)
+                    return false;
+
+                instanceArrayMembers.push_back ({ s, i });
+            }
+            else if (kind == Kind::packed)
+            {
+                if (! isPacked)
+                    return false;
+            }
+            else if (isPacked)
+            {
+                if (memberType.isSlice() || memberType.containsSlice() || memberType.isReference())
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool checkVariable (AST::VariableDeclaration& v)
+    {
+        auto kind = getKind (v.getType());
+
+        if (kind == Kind::unsupported)
+            return false;
+
+        if (kind == Kind::packed)
+            return v.isParameter() && v.getType()->isReference();
+
+        if (kind == Kind::instanceArray)
+        {
+            if (v.isParameter() || v.initialValue != nullptr)
+                return false;
+
+            instanceArrayVariables.push_back (v);
+        }
+
+        return true;
+    }
+
+    bool checkValue (AST::ValueBase& value)
+    {
+        auto kind = getKind (value.getResultType());
+
+        if (kind == Kind::unsupported)
+            return false;
+
+        if (auto call = value.getAsFunctionCall())
+            calls.push_back (*call);
+
+        if (auto m = value.getAsGetStructMember())
+            if (kind != Kind::packed && getKind (AST::castToValueRef (m->object).getResultType()) == Kind::packed)
+                memberAccesses.push_back (*m);
+
+        if (kind == Kind::packed)
+        {
+            if (auto v = value.getAsVariableReference())
+            {
+                if (! v->getVariable().isParameter())
+                    return false;
+            }
+            else if (auto e = value.getAsGetElement())
+            {
+                if (e->indexes.size() != 1 || getKind (AST::castToValueRef (e->parent).getResultType()) != Kind::instanceArray)
+                    return false;
+            }
+            else if (value.getAsGetStructMember() == nullptr)
+            {
+                return false;
+            }
+
+            for (auto referrer : value.getReferrers())
+                if (! isLive (referrer->owner) || ! isValidUseOfPackedValue (*referrer))
+                    return false;
+        }
+        else if (kind == Kind::instanceArray)
+        {
+            for (auto referrer : value.getReferrers())
+            {
+                if (isLive (referrer->owner))
+                {
+                    auto e = referrer->owner.getAsGetElement();
+
+                    if (e == nullptr || referrer != std::addressof (e->parent) || e->indexes.size() != 1)
+                        return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool isLive (const AST::Object& o) const
+    {
+        return liveObjectSet.find (std::addressof (o)) != liveObjectSet.end();
+    }
+
+    bool isValidUseOfPackedValue (AST::ObjectProperty& referrer) const
+    {
+        if (auto m = referrer.owner.getAsGetStructMember())
+            return std::addressof (referrer) == std::addressof (m->object);
+
+        if (auto call = referrer.owner.getAsFunctionCall())
+        {
+            if (auto fn = call->getTargetFunction())
+            {
+                auto paramTypes = fn->getParameterTypes();
+
+                for (size_t i = 0; i < call->arguments.size() && i < paramTypes.size(); ++i)
+                    if (call->arguments[i].getAsObjectProperty() == std::addressof (referrer))
+                        return getKind (paramTypes[i].get()) == Kind::packed && paramTypes[i]->isReference();
+            }
+        }
+
+        return false;
+    }
+
+    bool checkCallArguments (AST::FunctionCall& call) const
+    {
+        if (auto fn = call.getTargetFunction())
+        {
+            auto paramTypes = fn->getParameterTypes();
+
+            if (paramTypes.size() != call.arguments.size())
+                return false;
+
+            for (size_t i = 0; i < paramTypes.size(); ++i)
+                if ((getKind (paramTypes[i].get()) == Kind::packed) != (getKind (AST::castToValueRef (call.arguments[i]).getResultType()) == Kind::packed))
+                    return false;
+        }
+
+        return true;
+    }
+
+    //==============================================================================
+    void pack()
+    {
+        for (auto& f : functionsToExtend)
+        {
+            std::vector<ref<AST::VariableDeclaration>> packedParams;
+
+            for (auto& param : f->iterateParameters())
+                if (getKind (param.getType()) == Kind::packed)
+                    packedParams.push_back (param);
+
+            for (auto& param : packedParams)
+            {
+                auto lane = AST::addFunctionParameter (*f, program.allocator.int32Type,
+                                                       "_lane" + std::string (param->getName()));
+                laneParameters[param.getPointer()] = lane.variable;
+            }
+        }
+
+        for (auto& m : memberAccesses)
+        {
+            auto object = lower (AST::castToValueRef (m->object));
+            m->object.referTo (object.base);
+
+            auto& element = m->context.allocate<AST::GetElement>();
+            m->replaceWith ([&]() -> AST::Object& { return element; });
+            element.parent.referTo (*m);
+            element.indexes.addReference (createLaneIndex (object.lane, m->context));
+        }
+
+        for (auto& call : calls)
+        {
+            auto fn = call->getTargetFunction();
+
+            if (fn == nullptr)
+                continue;
+
+            auto paramTypes = fn->getParameterTypes();
+            auto numArgs = call->arguments.size();
+
+            for (size_t i = 0; i < numArgs; ++i)
+            {
+                if (getKind (paramTypes[i].get()) == Kind::packed)
+                {
+                    auto lowered = lower (AST::castToValueRef (call->arguments[i]));
+                    call->arguments[i].getAsObjectProperty()->referTo (lowered.base);
+                    call->arguments.addReference (createLaneIndex (lowered.lane, call->context));
+                }
+            }
+        }
+
+        for (auto& s : structsToPack)
+        {
+            for (size_t i = 0; i < s->memberTypes.size(); ++i)
+            {
+                auto& memberType = s->getMemberType (i);
+
+                if (getKind (memberType) != Kind::packed)
+                    s->memberTypes[i].getAsObjectProperty()->referTo (AST::createArrayOfType (*s, memberType, static_cast<int32_t> (numInstances)));
+            }
+        }
+
+        for (auto& [s, index] : instanceArrayMembers)
+            s->memberTypes[index].getAsObjectProperty()->referTo (*rootStruct);
+
+        for (auto& v : instanceArrayVariables)
+            v->declaredType.referTo (*rootStruct);
+
+        descriptions.push_back ("Packed " + std::to_string (numInstances) + " instances of "
+                                  + rootStruct->findParentOfType<AST::ProcessorBase>()->getFullyQualifiedReadableName()
+                                  + "::" + std::string (rootStruct->name.get()) + " into a struct of arrays");
+    }
+
+    // Returns the expression that a packed value's members should be read from, and the
+    // lane that it refers to. Parameters get their lane from the extra parameter that was
+    // added for them, and elements of a node array use the element index.
+    LoweredValue lower (AST::ValueBase& value)
+    {
+        if (auto found = loweredValues.find (std::addressof (value)); found != loweredValues.end())
+            return found->second;
+
+        auto result = [&]() -> LoweredValue
+        {
+            if (auto v = value.getAsVariableReference())
+                return { value, { laneParameters.at (std::addressof (v->getVariable())), {} } };
+
+            if (auto e = value.getAsGetElement())
+                return { AST::castToValueRef (e->parent), { {}, e->getSingleIndex() } };
+
+            auto& member = *value.getAsGetStructMember();
+            auto object = lower (AST::castToValueRef (member.object));
+            member.object.referTo (object.base);
+            return { value, object.lane };
+        }();
+
+        loweredValues.emplace (std::addressof (value), result);
+        return result;
+    }
+
+    // An element's index expression can be needed by several member accesses and calls,
+    // so each one gets its own copy rather than sharing a single parent.
+    static AST::Object& createLaneIndex (const Lane& lane, const AST::ObjectContext& context)
+    {
+        if (lane.parameter != nullptr)
+            return AST::createVariableReference (context, *lane.parameter);
+
+        return context.allocator.createDeepClone (*lane.index);
+    }
+};
+
+inline std::string packNodeArrays (AST::Program& program)
+{
+    return PackNodeArrays (program).run();
+}
+
+}
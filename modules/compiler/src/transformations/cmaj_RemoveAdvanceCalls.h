@@ -30,6 +30,7 @@ struct RemoveAdvanceCalls  : public AST::NonParameterisedObjectVisitor
     CMAJ_DO_NOT_VISIT_CONSTANTS
 
     bool useForwardBranch = false;
+    bool loweredToPerFrameFunction = false;
 
     std::vector<ref<AST::Advance>> advanceCalls;
     std::vector<ref<AST::ReturnStatement>> returnStatements;
@@ -44,6 +45,18 @@ struct RemoveAdvanceCalls  : public AST::NonParameterisedObjectVisitor
 
             if (! advanceCalls.empty())
             {
+                if (isSingleAdvancingLoop (*f.getMainBlock()))
+                {
+                    // Each call to main will run exactly one iteration of the loop, so there's no
+                    // position to resume from, and the advance can just become a return
+                    auto& advance = advanceCalls.front().get();
+                    auto& block = AST::castToRef<AST::ScopeBlock> (advance.getParentScope());
+                    block.setStatement (static_cast<size_t> (block.findIndexOfStatementContaining (advance)),
+                                        block.allocateChild<AST::ReturnStatement>());
+                    loweredToPerFrameFunction = true;
+                    return;
+                }
+
                 auto& processor = f.getParentProcessor();
                 auto& resumeIndex = AST::createStateVariable (processor, "_resumeIndex", f.context.allocator.createInt32Type(), {});
 
@@ -80,6 +93,28 @@ struct RemoveAdvanceCalls  : public AST::NonParameterisedObjectVisitor
         returnStatements.push_back (r);
     }
 
+    /// Looks for a main function of the form `loop { ...; advance(); }`, where the loop is
+    /// never exited and the advance is the only one.
+    bool isSingleAdvancingLoop (AST::ScopeBlock& mainBlock) const
+    {
+        if (advanceCalls.size() != 1 || ! returnStatements.empty() || mainBlock.statements.empty())
+            return false;
+
+        auto& advance = advanceCalls.front().get();
+        auto block = AST::castTo<AST::ScopeBlock> (advance.getParentScope());
+
+        if (block == nullptr || block->findIndexOfStatementContaining (advance) != static_cast<int32_t> (block->statements.size() - 1))
+            return false;
+
+        auto parentLoop = AST::castTo<AST::LoopStatement> (block->getParentScope());
+
+        return parentLoop != nullptr
+                && parentLoop->isInfinite()
+                && parentLoop->iterator == nullptr
+                && parentLoop == mainBlock.statements.front().getObjectRef()
+                && validation::StatementExitMethods (mainBlock).doesNotExit();
+    }
+
     //==============================================================================
     void replaceNodeAdvanceCall (AST::Advance& advance)
     {
@@ -474,11 +509,14 @@ struct RemoveAdvanceCalls  : public AST::NonParameterisedObjectVisitor
     }
 };
 
-inline void removeAdvanceCalls (AST::ProcessorBase& processor, bool useForwardBranch)
+/// Returns true if the processor's main function was a simple loop that could be
+/// turned into a function which renders a single frame per call.
+inline bool removeAdvanceCalls (AST::ProcessorBase& processor, bool useForwardBranch)
 {
     RemoveAdvanceCalls remover (processor.context.allocator);
     remover.useForwardBranch = useForwardBranch;
     remover.visitObject (processor);
+    return remover.loweredToPerFrameFunction;
 }
 
 }
@@ -20,15 +20,22 @@ namespace cmaj::transformations
 {
 
 /// Coalesces chained connections and replaces delay connections with nodes
-/// to implement delays
-inline void simplifyGraphConnections (AST::Program& program)
+/// to implement delays.
+///
+/// The size of the queue used by an event delay is derived from the number of blocks
+/// that the delay can span, the number of sources feeding the connection, and the event
+/// buffer size.
+///
+/// Returns a description of the event delay queues that were created, for the build log.
+inline std::string simplifyGraphConnections (AST::Program& program, uint32_t eventBufferSize, uint32_t maxBlockSize)
 {
     struct SimplifyConnectionPass  : public passes::PassAvoidingGenericFunctionsAndModules
     {
         using super = PassAvoidingGenericFunctionsAndModules;
         using super::visit;
 
-        SimplifyConnectionPass (AST::Program& p) : super (p) {}
+        SimplifyConnectionPass (AST::Program& p, uint32_t bufferSize, uint32_t blockSize)
+            : super (p), eventBufferSize (bufferSize), maxBlockSize (blockSize) {}
 
         CMAJ_DO_NOT_VISIT_CONSTANTS
 
@@ -41,7 +48,10 @@ inline void simplifyGraphConnections (AST::Program& program)
             transformConnectionList (graph, graph.connections);
         }
 
+        std::vector<std::string> queueDescriptions;
+
     private:
+        const uint32_t eventBufferSize, maxBlockSize;
         int nextDelayID = 1;
 
         void transformConnectionList (AST::Graph& graph, AST::ListProperty& connectionList)
@@ -138,7 +148,11 @@ inline void simplifyGraphConnections (AST::Program& program)
             args.items.addReference (*connection.delayLength->getAsValueBase());
 
             if (sourceEndpointDeclaration.isEvent())
-                args.items.addChildObject (graph.context.allocator.createConstantInt32 (100));
+            {
+                auto queueSize = getEventQueueSize (connection);
+                args.items.addChildObject (graph.context.allocator.createConstantInt32 (queueSize));
+                describeEventQueue (graph, graphNode, queueSize, connectionDataTypes);
+            }
 
             auto& processor = graph.allocateChild<AST::CallOrCast>();
 
@@ -169,6 +183,42 @@ inline void simplifyGraphConnections (AST::Program& program)
             return true;
         }
 
+        /// Any events which don't fit in the queue get dropped, so it has to hold everything that
+        /// can be in flight. Each source can send up to the event buffer size in each block, and
+        /// the events that are waiting at any moment were sent during the last delayLength
+        /// frames, which can overlap one more block than the number that the delay spans.
+        int32_t getEventQueueSize (const AST::Connection& connection) const
+        {
+            int64_t delayLength = 1;
+
+            if (auto delayConst = AST::getAsFoldedConstant (connection.delayLength))
+                if (auto value = delayConst->getAsInt64())
+                    delayLength = std::max (*value, static_cast<int64_t> (1));
+
+            auto blockSize = static_cast<int64_t> (std::max (maxBlockSize, 1u));
+            auto numBlocks = (delayLength + blockSize - 1) / blockSize + 1;
+            auto numSources = static_cast<int64_t> (std::max (connection.sources.size(), static_cast<size_t> (1)));
+            auto queueSize = numBlocks * static_cast<int64_t> (eventBufferSize) * numSources;
+
+            return static_cast<int32_t> (std::min (queueSize, static_cast<int64_t> (std::numeric_limits<int32_t>::max())));
+        }
+
+        void describeEventQueue (const AST::Graph& graph, const AST::GraphNode& delayNode, int32_t queueSize,
+                                 const AST::ObjectRefVector<const AST::TypeBase>& types)
+        {
+            // each entry holds the event's due time, plus a type index when there's more than one type
+            size_t entrySize = types.size() == 1 ? 4 : 8;
+
+            for (auto& t : types)
+                if (! t->isVoid())
+                    entrySize += t->getPackedStorageSize();
+
+            queueDescriptions.push_back ("Event delay queue for " + graph.getFullyQualifiedReadableName()
+                                           + "." + std::string (delayNode.getName().get()) + ": "
+                                           + std::to_string (queueSize) + " events, "
+                                           + std::to_string (static_cast<size_t> (queueSize) * entrySize) + " bytes");
+        }
+
         AST::Expression& getEventDelayProcessor (AST::Graph& graph, AST::ObjectRefVector<const AST::TypeBase> types)
         {
             if (types.size() == 1 && ! types[0]->isVoid())
@@ -436,7 +486,9 @@ inline void simplifyGraphConnections (AST::Program& program)
         }
     };
 
-    SimplifyConnectionPass (program).visitObject (program.rootNamespace);
+    SimplifyConnectionPass pass (program, eventBufferSize, maxBlockSize);
+    pass.visitObject (program.rootNamespace);
+    return choc::text::joinStrings (pass.queueDescriptions, "\n");
 }
 
 }
@@ -24,7 +24,8 @@ struct FlattenGraph
 {
     struct Renderer
     {
-        Renderer (AST::ProcessorBase& g, ProcessorInfo::GetInfo getInfo) : graph (g), getProcessorInfo (getInfo)
+        Renderer (AST::ProcessorBase& g, ProcessorInfo::GetInfo getInfo, std::unique_ptr<NodeProfiling> profiling = {})
+            : graph (g), getProcessorInfo (getInfo), nodeProfiling (std::move (profiling))
         {
             initFunction = g.findSystemInitFunction();
             mainFunction = g.findMainFunction();
@@ -181,6 +182,17 @@ struct FlattenGraph
                                        *ioVariable,
                                        mainFunction->context.allocate<AST::ScopeBlock>() };
 
+            if (! useStateForIO)
+            {
+                if (auto holdFrames = SparseStreamSupport::getSilenceHoldFrames (*processorType))
+                {
+                    newInstance.silenceHoldFrames = *holdFrames;
+
+                    if (*holdFrames > 0)
+                        newInstance.silentFrameCounter = SparseStreamSupport::createSilentFrameCounter (graph, node);
+                }
+            }
+
             nodeInstanceInfoMap[std::addressof (node)] = std::make_unique<InstanceInfo> (std::move (newInstance));
             nodesToRender.push_back (std::addressof (node));
 
@@ -310,6 +322,8 @@ struct FlattenGraph
             ptr<AST::ScopeBlock> steps;
             AST::ObjectRefVector<const AST::GraphNode> dependencies;
             AST::ObjectRefVector<const AST::GraphNode> delayDependencies;
+            std::optional<int32_t> silenceHoldFrames;
+            ptr<AST::VariableReference> silentFrameCounter;
             bool hasBeenRun = false;
 
             void addDependencies (const AST::Expression& source)
@@ -818,24 +832,65 @@ struct FlattenGraph
         {
             if (auto processorMainFunction = node.getProcessorType()->findMainFunction())
             {
-                auto& instanceInfo = getInfoForNode (node);
-
-                if (auto arraySize = node.getArraySize())
-                {
-                    addLoop (block, *arraySize, [&] (AST::ScopeBlock& loopBlock, AST::ValueBase& index)
+                if (nodeProfiling != nullptr)
+                    nodeProfiling->addTimedBlock (*block, node.getName().get(), [&] (AST::ScopeBlock& timedBlock)
                     {
-                        addRunCall (loopBlock,
-                                    processorMainFunction,
-                                    AST::createGetElement (block, instanceInfo.stateVariable, index),
-                                    AST::createGetElement (block, instanceInfo.ioVariable, index));
+                        addUntimedRunCall (timedBlock, node, processorMainFunction);
                     });
-                }
                 else
+                    addUntimedRunCall (block, node, processorMainFunction);
+            }
+        }
+
+        void addUntimedRunCall (ptr<AST::ScopeBlock> block, const AST::GraphNode& node, ptr<AST::Function> processorMainFunction)
+        {
+            auto& instanceInfo = getInfoForNode (node);
+
+            if (auto arraySize = node.getArraySize())
+            {
+                addLoop (block, *arraySize, [&] (AST::ScopeBlock& loopBlock, AST::ValueBase& index)
                 {
-                    addRunCall (block, processorMainFunction,
-                                instanceInfo.stateVariable, instanceInfo.ioVariable);
-                }
+                    auto& stateElement = AST::createGetElement (block, instanceInfo.stateVariable, index);
+                    auto& ioElement = AST::createGetElement (block, instanceInfo.ioVariable, index);
+
+                    if (instanceInfo.silenceHoldFrames)
+                    {
+                        ptr<AST::ValueBase> counterElement;
+
+                        if (instanceInfo.silentFrameCounter != nullptr)
+                            counterElement = AST::createGetElement (block, *instanceInfo.silentFrameCounter, index);
+
+                        addRunCallSkippingSilence (loopBlock, node, processorMainFunction, stateElement, ioElement,
+                                                   counterElement, *instanceInfo.silenceHoldFrames);
+                    }
+                    else
+                    {
+                        addRunCall (loopBlock, processorMainFunction, stateElement, ioElement);
+                    }
+                });
             }
+            else if (instanceInfo.silenceHoldFrames)
+            {
+                addRunCallSkippingSilence (*block, node, processorMainFunction,
+                                           instanceInfo.stateVariable, instanceInfo.ioVariable,
+                                           instanceInfo.silentFrameCounter, *instanceInfo.silenceHoldFrames);
+            }
+            else
+            {
+                addRunCall (block, processorMainFunction,
+                            instanceInfo.stateVariable, instanceInfo.ioVariable);
+            }
+        }
+
+        static void addRunCallSkippingSilence (AST::ScopeBlock& block, const AST::GraphNode& node, ptr<AST::Function> mainFunction,
+                                               AST::ValueBase& stateVariable, AST::ValueBase& ioVariable,
+                                               ptr<AST::ValueBase> silentFrameCounter, int32_t holdFrames)
+        {
+            SparseStreamSupport::addRunCallSkippingSilence (block, node.getName().get(), *node.getProcessorType(), ioVariable,
+                                                            silentFrameCounter, holdFrames, [&]() -> AST::Statement&
+            {
+                return AST::createFunctionCall (block, *mainFunction, stateVariable, ioVariable);
+            });
         }
 
         static void addRunCall (ptr<AST::ScopeBlock> block, ptr<AST::Function> mainFunction,
@@ -873,6 +928,7 @@ struct FlattenGraph
 
         AST::ProcessorBase& graph;
         ProcessorInfo::GetInfo getProcessorInfo;
+        std::unique_ptr<NodeProfiling> nodeProfiling;
         ptr<AST::Function> initFunction, mainFunction;
         int32_t nextProcessorId = 1;
 
@@ -881,9 +937,10 @@ struct FlattenGraph
         ptr<AST::ScopeBlock> processorGraphOutput;
     };
 
-    static void flattenGraph (AST::Graph& graph, ProcessorInfo::GetInfo getInfo, uint32_t eventBufferSize, bool isTopLevelProcessor)
+    static void flattenGraph (AST::Graph& graph, ProcessorInfo::GetInfo getInfo, uint32_t eventBufferSize, bool isTopLevelProcessor,
+                              std::unique_ptr<NodeProfiling> nodeProfiling)
     {
-        Renderer renderer (graph, getInfo);
+        Renderer renderer (graph, getInfo, std::move (nodeProfiling));
 
         for (auto& i : graph.nodes)
             if (auto node = AST::castTo<AST::GraphNode> (i))
@@ -1004,7 +1061,8 @@ struct FlattenGraph
 inline void flatten (AST::Program& program, AST::ProcessorBase& processor,
                      bool isTopLevelProcessor, ProcessorInfo::GetInfo getInfo,
                      uint32_t eventBufferSize,
-                     bool useForwardBranch)
+                     bool useForwardBranch,
+                     bool profileNodes = false)
 {
     // First ensure all nodes are flattened
     for (auto& n : processor.nodes)
@@ -1031,7 +1089,8 @@ inline void flatten (AST::Program& program, AST::ProcessorBase& processor,
 
     if (auto graph = processor.getAsGraph())
     {
-        FlattenGraph::flattenGraph (*graph, getInfo, eventBufferSize, isTopLevelProcessor);
+        FlattenGraph::flattenGraph (*graph, getInfo, eventBufferSize, isTopLevelProcessor,
+                                    profileNodes ? std::make_unique<NodeProfiling> (program, *graph) : nullptr);
     }
     else
     {
@@ -1039,32 +1098,57 @@ inline void flatten (AST::Program& program, AST::ProcessorBase& processor,
         moveProcessorPropertiesToState (processor, getInfo, std::addressof (program.getMainProcessor()) == std::addressof (processor));
         FlattenGraph::addProcessorNodes (processor, getInfo, eventBufferSize, isTopLevelProcessor);
         removeResetCalls (processor);
-        removeAdvanceCalls (processor, useForwardBranch);
+        getInfo (processor).hasPerFrameMainFunction = removeAdvanceCalls (processor, useForwardBranch);
         moveStateVariablesToStruct (processor, eventBufferSize, isTopLevelProcessor);
     }
 }
 
-inline void flattenGraph (AST::Program& program,
-                          uint32_t maxBlockSize,
-                          uint32_t eventBufferSize,
-                          bool useForwardBranch)
+/// Flattens the program, and returns a description of which processors had their
+/// main loops lowered to simple per-frame functions, for use in the build log.
+/// If profileNodes is true, the nodes of the top-level graph are instrumented
+/// (see NodeProfiling).
+inline std::string flattenGraph (AST::Program& program,
+                                 uint32_t maxBlockSize,
+                                 uint32_t eventBufferSize,
+                                 bool useForwardBranch,
+                                 bool profileNodes)
 {
     ProcessorInfoManager processorInfoManager;
 
     bool isBlockProcessor = maxBlockSize > 1;
 
     flatten (program, program.getMainProcessor(), ! isBlockProcessor,
-             processorInfoManager.getProcessorInfo(), eventBufferSize, useForwardBranch);
+             processorInfoManager.getProcessorInfo(), eventBufferSize, useForwardBranch, profileNodes);
+
+    std::vector<std::string> loweredProcessors;
+
+    for (auto& info : processorInfoManager.processorInfoMap)
+        if (info.second.hasPerFrameMainFunction)
+            loweredProcessors.push_back (info.first->getFullyQualifiedReadableName());
+
+    std::sort (loweredProcessors.begin(), loweredProcessors.end());
+
+    std::string description;
+
+    if (! loweredProcessors.empty())
+        description = "Per-frame main loops: " + choc::text::joinStrings (loweredProcessors, ", ");
 
     if (isBlockProcessor)
     {
+        bool hasCountedBlockLoop = canUseLocalFrameCounter (program.getMainProcessor());
+
         auto& blockProcessor = createBlockTransformProcessor (program.getMainProcessor(), maxBlockSize);
         moveStateVariablesToStruct (blockProcessor, eventBufferSize, true);
 
         program.setMainProcessor (blockProcessor);
+
+        if (hasCountedBlockLoop)
+            description += std::string (description.empty() ? "" : "\n")
+                             + "Counted block loop: " + blockProcessor.getFullyQualifiedReadableName();
     }
 
     canonicaliseLoopsAndBlocks (program);
+    return description;
 }
 
 }
@@ -38,6 +38,7 @@
 #include "cmaj_ProcessorPropertiesToState.h"
 #include "cmaj_CanonicaliseLoopsAndBlocks.h"
 #include "cmaj_OversamplingTransformation.h"
+#include "cmaj_AddSparseStreamSupport.h"
 #include "cmaj_TransformGraph.h"
 #include "cmaj_HoistedEndpointConnector.h"
 #include "cmaj_SimplifyGraphConnections.h"
@@ -47,7 +48,6 @@
 #include "cmaj_FunctionInliner.h"
 #include "cmaj_RemoveUnusedEndpoints.h"
 #include "cmaj_RemoveUnusedNodes.h"
-#include "cmaj_AddSparseStreamSupport.h"
 #include "cmaj_CloneGraphNodes.h"
 #include "cmaj_BinaryModuleFormat.h"
 #include "cmaj_MergeDuplicateNamespaces.h"
@@ -57,6 +57,8 @@
 #include "cmaj_AddFallbackIntrinsics.h"
 #include "cmaj_ReplaceMultidimensionalArrays.h"
 #include "cmaj_ConvertLargeConstants.h"
+#include "cmaj_OptimiseStateLayout.h"
+#include "cmaj_PackNodeArrays.h"
 
 namespace cmaj::transformations
 {
@@ -67,28 +69,36 @@ static void runResolutionPasses (AST::Program& program, bool throwOnErrors)
     {
         passes::PassResult result;
 
-        result += passes::runPass<passes::TypeResolver>             (program, throwOnErrors);
-        result += passes::runPass<passes::FunctionResolver>         (program, throwOnErrors);
-        result += passes::runPass<passes::NameResolver>             (program, throwOnErrors);
-        result += passes::runPass<passes::ModuleSpecialiser>        (program, throwOnErrors);
-        result += passes::runPass<passes::ProcessorResolver>        (program, throwOnErrors);
-        result += passes::runPass<passes::EndpointResolver>         (program, throwOnErrors);
-        result += passes::runPass<passes::ConstantFolder>           (program, throwOnErrors);
-        result += passes::runPass<passes::StrengthReduction>        (program, throwOnErrors);
-        result += passes::runPass<passes::ExternalResolver>         (program, throwOnErrors);
+        result += passes::runPass<passes::TypeResolver>             (program, throwOnErrors, "TypeResolver");
+        result += passes::runPass<passes::FunctionResolver>         (program, throwOnErrors, "FunctionResolver");
+        result += passes::runPass<passes::NameResolver>             (program, throwOnErrors, "NameResolver");
+        result += passes::runPass<passes::ModuleSpecialiser>        (program, throwOnErrors, "ModuleSpecialiser");
+        result += passes::runPass<passes::ProcessorResolver>        (program, throwOnErrors, "ProcessorResolver");
+        result += passes::runPass<passes::EndpointResolver>         (program, throwOnErrors, "EndpointResolver");
+        result += passes::runPass<passes::ConstantFolder>           (program, throwOnErrors, "ConstantFolder");
+        result += passes::runPass<passes::StrengthReduction>        (program, throwOnErrors, "StrengthReduction");
+        result += passes::runPass<passes::ExternalResolver>         (program, throwOnErrors, "ExternalResolver");
 
         if (result.numChanges == 0)
             return;
     }
 }
 
+// Runs a transformation, timing it if PassTimings are being collected
+template <typename TransformFn>
+static auto runTimed (AST::Program& program, std::string_view name, TransformFn&& transform)
+{
+    PassTimer timer (name, program.allocator);
+    return transform();
+}
+
 static void runFullResolutionAndChecks (AST::Program& program, uint64_t stackSizeLimit, bool allowTopLevelSlices, bool allowExternalFunctions)
 {
     runResolutionPasses (program, false);
-    passes::DuplicateNameCheckPass::check (program);
+    runTimed (program, "DuplicateNameCheck", [&] { passes::DuplicateNameCheckPass::check (program); });
     runResolutionPasses (program, true);
 
-    validation::PostLink::check (program, stackSizeLimit, allowTopLevelSlices, allowExternalFunctions);
+    runTimed (program, "PostLinkValidation", [&] { validation::PostLink::check (program, stackSizeLimit, allowTopLevelSlices, allowExternalFunctions); });
 }
 
 void runBasicResolutionPasses (AST::Program& program)
@@ -100,10 +110,10 @@ void prepareForResolution (AST::Program& program, uint64_t stackSizeLimit)
 {
     runResolutionPasses (program, false);
 
-    if (! validation::PostLoad::check (program))
+    if (! runTimed (program, "PostLoadValidation", [&] { return validation::PostLoad::check (program); }))
         runFullResolutionAndChecks (program, stackSizeLimit, false, true);
 
-    createHoistedEndpointConnections (program);
+    runTimed (program, "createHoistedEndpointConnections", [&] { createHoistedEndpointConnections (program); });
 }
 
 void prepareForCodeGen (AST::Program& program,
@@ -114,41 +124,77 @@ void prepareForCodeGen (AST::Program& program,
                         bool allowExternalFunctions,
                         const std::function<bool(AST::Intrinsic::Type)>& engineSupportsIntrinsic,
                         double& resultLatency,
-                        const std::function<bool(const EndpointID&)>& isEndpointActive)
+                        const std::function<bool(const EndpointID&)>& isEndpointActive,
+                        std::string* transformationNotes)
 {
     CMAJ_ASSERT (buildSettings.getMaxBlockSize() != 0 && buildSettings.getEventBufferSize() != 0);
 
-    cloneGraphNodes (program);
+    runTimed (program, "cloneGraphNodes", [&] { cloneGraphNodes (program); });
+
+    auto replaceProperties = [&]
+    {
+        return runTimed (program, "replaceProcessorProperties", [&]
+        {
+            return replaceProcessorProperties (program, buildSettings.getMaxFrequency(), buildSettings.getFrequency(), useDynamicSampleRate);
+        });
+    };
 
-    auto processorReplacementState = replaceProcessorProperties (program, buildSettings.getMaxFrequency(), buildSettings.getFrequency(), useDynamicSampleRate);
+    auto processorReplacementState = replaceProperties();
 
     while (processorReplacementState.propertiesReplaced != 0)
     {
         runFullResolutionAndChecks (program, buildSettings.getMaxStackSize(), allowTopLevelSlices, allowExternalFunctions);
-        processorReplacementState = replaceProcessorProperties (program, buildSettings.getMaxFrequency(), buildSettings.getFrequency(), useDynamicSampleRate);
+        processorReplacementState = replaceProperties();
     }
 
     runFullResolutionAndChecks (program, buildSettings.getMaxStackSize(), allowTopLevelSlices, allowExternalFunctions);
-    simplifyGraphConnections (program);
+    auto eventQueueNotes = runTimed (program, "simplifyGraphConnections", [&] { return simplifyGraphConnections (program, buildSettings.getEventBufferSize(), buildSettings.getMaxBlockSize()); });
     runResolutionPasses (program, allowTopLevelSlices);
 
     resultLatency = program.getMainProcessor().getLatency();
 
-    determineFunctionAliasStatus (program);
-    removeUnusedNodes (program);
-    removeGenericAndParameterisedObjects (program);
-    removeUnusedEndpoints (program, isEndpointActive);
+    runTimed (program, "determineFunctionAliasStatus",         [&] { determineFunctionAliasStatus (program); });
+    runTimed (program, "removeUnusedNodes",                    [&] { removeUnusedNodes (program); });
+    runTimed (program, "removeGenericAndParameterisedObjects", [&] { removeGenericAndParameterisedObjects (program); });
+    runTimed (program, "removeUnusedEndpoints",                [&] { removeUnusedEndpoints (program, isEndpointActive); });
     runResolutionPasses (program, allowTopLevelSlices);
-    convertComplexTypes (program);
-    addFallbackIntrinsics (program, engineSupportsIntrinsic);
-    canonicaliseLoopsAndBlocks (program);
-    replaceWrapTypesAndLoopCounters (program);
-    replaceMultidimensionalArrays (program);
-    convertUnwrittenVariablesToConst (program);
-    inlineAllCallsWhichAdvance (program);
-    createSystemInitFunctions (program, processorReplacementState.sessionIDVariable, processorReplacementState.frequencyVariable);
-    convertLargeConstantsToGlobals (program);
-    flattenGraph (program, buildSettings.getMaxBlockSize(), buildSettings.getEventBufferSize(), useForwardBranchesForAdvance);
+    runTimed (program, "convertComplexTypes",                  [&] { convertComplexTypes (program); });
+    runTimed (program, "addFallbackIntrinsics",                [&] { addFallbackIntrinsics (program, engineSupportsIntrinsic, buildSettings.shouldUseApproximateMaths()); });
+    runTimed (program, "canonicaliseLoopsAndBlocks",           [&] { canonicaliseLoopsAndBlocks (program); });
+    runTimed (program, "replaceWrapTypesAndLoopCounters",      [&] { replaceWrapTypesAndLoopCounters (program); });
+    runTimed (program, "replaceMultidimensionalArrays",        [&] { replaceMultidimensionalArrays (program); });
+    runTimed (program, "convertUnwrittenVariablesToConst",     [&] { convertUnwrittenVariablesToConst (program); });
+    runTimed (program, "inlineAllCallsWhichAdvance",           [&] { inlineAllCallsWhichAdvance (program); });
+
+    runTimed (program, "createSystemInitFunctions", [&]
+    {
+        createSystemInitFunctions (program, processorReplacementState.sessionIDVariable, processorReplacementState.frequencyVariable);
+    });
+
+    runTimed (program, "convertLargeConstantsToGlobals", [&] { convertLargeConstantsToGlobals (program); });
+
+    auto notes = runTimed (program, "flattenGraph", [&]
+    {
+        return flattenGraph (program, buildSettings.getMaxBlockSize(), buildSettings.getEventBufferSize(), useForwardBranchesForAdvance,
+                             buildSettings.shouldProfileNodes() && allowExternalFunctions);
+    });
+
+    auto addNotes = [&] (const std::string& description)
+    {
+        if (! description.empty())
+            notes += (notes.empty() ? "" : "\n") + description;
+    };
+
+    addNotes (eventQueueNotes);
+
+    if (buildSettings.shouldPackNodeArrays())
+        addNotes (runTimed (program, "packNodeArrays", [&] { return packNodeArrays (program); }));
+
+    if (buildSettings.shouldOptimiseStateLayout())
+        addNotes (runTimed (program, "optimiseStateLayout", [&] { return optimiseStateLayout (program); }));
+
+    if (transformationNotes != nullptr)
+        *transformationNotes = std::move (notes);
 }
 
 void prepareForGraphGen (AST::Program& program,
@@ -158,7 +204,7 @@ void prepareForGraphGen (AST::Program& program,
     cloneGraphNodes (program);
     replaceProcessorProperties (program, frequency, frequency, false);
     runFullResolutionAndChecks (program, stackSizeLimit, true, true);
-    simplifyGraphConnections (program);
+    simplifyGraphConnections (program, BuildSettings::defaultEventBufferSize, BuildSettings::defaultMaxBlockSize);
     runResolutionPasses (program, true);
 }
 
@@ -18,6 +18,7 @@
 
 #include "cmaj_EventHandlerUtilities.h"
 #include "cmaj_ValueStreamUtilities.h"
+#include "cmaj_NodeProfiling.h"
 
 namespace cmaj::transformations
 {
@@ -29,7 +30,8 @@ namespace cmaj::transformations
 
     /// After resolving the program, this does a full validity check, flattens any graphs and
     /// runs transformations to lower its structure to a simpler subset of the AST that's
-    /// suitable for the code generator to use
+    /// suitable for the code generator to use. If transformationNotes is supplied, it's given
+    /// a description of any optional optimisations that were applied, for the build log.
     void prepareForCodeGen (AST::Program&,
                             const BuildSettings&,
                             bool useForwardBranchesForAdvance,
@@ -38,7 +40,8 @@ namespace cmaj::transformations
                             bool allowExternalFunctions,
                             const std::function<bool(AST::Intrinsic::Type)>& engineSupportsIntrinsic,
                             double& resultLatency,
-                            const std::function<bool(const EndpointID&)>& isEndpointActive);
+                            const std::function<bool(const EndpointID&)>& isEndpointActive,
+                            std::string* transformationNotes = nullptr);
 
     // Run passes for graph generation
     void prepareForGraphGen (AST::Program&,
@@ -55,12 +58,16 @@ namespace cmaj::transformations
     /// Blanks-out the names of any internal symbols in this program
     void obfuscateNames (AST::Program&);
 
-    /// Store a set of top-level AST objects as a binary module
-    std::vector<uint8_t> createBinaryModule (const AST::ObjectRefVector<AST::ModuleBase>& objects);
+    /// Store a set of top-level AST objects as a binary module. If the source text that
+    /// the objects were parsed from is provided, their locations within it are also stored.
+    std::vector<uint8_t> createBinaryModule (const AST::ObjectRefVector<AST::ModuleBase>& objects,
+                                             std::string_view sourceText = {});
 
-    /// Reloads a set of objects from a binary module that was created with createBinaryModule()
+    /// Reloads a set of objects from a binary module that was created with createBinaryModule().
+    /// To restore the objects' source locations, the same source text must be provided.
     AST::ObjectRefVector<AST::ModuleBase> parseBinaryModule (AST::Allocator&, const void*, size_t,
-                                                             bool checkHashValidity = true);
+                                                             bool checkHashValidity = true,
+                                                             std::string_view sourceText = {});
 
     /// Checks whether this seems to be a valid chunk of module data
     bool isValidBinaryModuleData (const void*, size_t);
@@ -16,6 +16,8 @@
 //  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
 //  DISCLAIMED.
 
+#include "cmaj_HalfBandFilterCascade.h"
+
 namespace cmaj
 {
 
@@ -26,6 +28,9 @@ struct GraphConnectivityModel
 
     GraphConnectivityModel (const AST::Graph& graph)
     {
+        // the sources hold pointers to other nodes, so this mustn't get reallocated
+        nodes.reserve (graph.nodes.size());
+
         for (auto& node : graph.nodes)
             addNode (AST::castToRefSkippingReferences<AST::GraphNode> (node));
 
@@ -99,21 +104,52 @@ struct GraphConnectivityModel
             return outputInterpolationMode;
         }
 
-        double getLongestDelayFromSource (std::vector<const Node*>& visited) const
+        /// Returns the longest delay along any path from a graph input to this node's output.
+        /// Each node's result is cached, so finding it for every node in the graph takes
+        /// time proportional to the number of connections, however many paths there are.
+        double getLongestDelayFromSource() const
         {
-            if (std::find (visited.begin(), visited.end(), this) != visited.end())
+            if (longestDelayFromSource)
+                return *longestDelayFromSource;
+
+            // a node that's already being calculated means there's a cycle, which will
+            // be reported elsewhere, so it just needs to be cut here
+            if (isCalculatingDelay)
                 return 0;
 
             double longest = 0;
-            visited.push_back (this);
+            isCalculatingDelay = true;
 
             for (auto& source : sources)
                 if (source.node)
-                    longest = std::max (longest, source.node->getLongestDelayFromSource (visited));
+                    longest = std::max (longest, source.node->getLongestDelayFromSource());
 
-            visited.pop_back();
+            isCalculatingDelay = false;
 
-            return longest + node.getProcessorType()->getLatency() / node.getClockMultiplier();
+            longestDelayFromSource = longest + node.getProcessorType()->getLatency() / node.getClockMultiplier() + getResamplingLatency();
+            return *longestDelayFromSource;
+        }
+
+        // Unlike the other strategies, the polyphase filters have a known, constant delay,
+        // which is reported as part of the graph's latency
+        double getResamplingLatency() const
+        {
+            auto multiplier = node.getClockMultiplier();
+
+            if (multiplier == 1.0)
+                return 0;
+
+            bool isOversampled = multiplier > 1.0;
+            auto factor = static_cast<int32_t> (isOversampled ? multiplier : 1.0 / multiplier);
+            double latency = 0;
+
+            if (inputInterpolationMode == AST::InterpolationTypeEnum::Enum::polyphase)
+                latency += HalfBandFilterCascade::getLatency (factor, isOversampled, true);
+
+            if (outputInterpolationMode == AST::InterpolationTypeEnum::Enum::polyphase)
+                latency += HalfBandFilterCascade::getLatency (factor, isOversampled, false);
+
+            return latency;
         }
 
         void setIndirectConnectionFlag()
@@ -127,6 +163,10 @@ struct GraphConnectivityModel
                         s.node->setIndirectConnectionFlag();
             }
         }
+
+        // Cached results, and the state used while finding them
+        mutable std::optional<double> longestDelayFromSource;
+        mutable bool isCalculatingDelay = false, isOnCurrentPath = false, isKnownToBeAcyclic = false;
     };
 
     std::vector<Node> nodes;
@@ -135,6 +175,7 @@ struct GraphConnectivityModel
     //==============================================================================
     void addNode (const AST::GraphNode& node)
     {
+        nodeIndexes[std::addressof (node)] = nodes.size();
         nodes.push_back ({ node });
     }
 
@@ -229,31 +270,26 @@ struct GraphConnectivityModel
         }
     }
 
-    double calculateTotalDelay()
+    double calculateTotalDelay() const
     {
         double longest = 0;
-        std::vector<const Node*> visited;
 
         for (auto& n : nodes)
-        {
             if (n.isDirectlyConnectedToOutput)
-            {
-                visited.clear();
-                longest = std::max (longest, n.getLongestDelayFromSource (visited));
-            }
-        }
+                longest = std::max (longest, n.getLongestDelayFromSource());
 
         return longest;
     }
 
 private:
     //==============================================================================
+    std::unordered_map<const AST::GraphNode*, size_t> nodeIndexes;
+
     ptr<Node> findNode (ptr<const AST::GraphNode> node)
     {
         if (node)
-            for (auto& n : nodes)
-                if (std::addressof (n.node) == std::addressof (*node))
-                    return n;
+            if (auto i = nodeIndexes.find (node.get()); i != nodeIndexes.end())
+                return nodes[i->second];
 
         return {};
     }
@@ -277,17 +313,26 @@ private:
         return choc::text::joinStrings (names, " -> ");
     }
 
+    // A node that has been fully explored without finding a cycle can't lead to one, so
+    // it's skipped on later visits. The first cycle found, and the path reported for it,
+    // are the same as they would be if every path was followed.
     static void followConnections (ptr<const AST::Connection> connection, const Node& node, std::vector<const Node*>& visited)
     {
-        if (std::find (visited.begin(), visited.end(), std::addressof (node)) != visited.end())
+        if (node.isKnownToBeAcyclic)
+            return;
+
+        if (node.isOnCurrentPath)
             throwError (*connection, Errors::feedbackInGraph (getCycleNameList (visited)));
 
         visited.push_back (std::addressof (node));
+        node.isOnCurrentPath = true;
 
         for (auto& source : node.sources)
             if (source.node)
                 followConnections (source.connection, *source.node, visited);
 
+        node.isOnCurrentPath = false;
+        node.isKnownToBeAcyclic = true;
         visited.pop_back();
     }
 
@@ -309,7 +354,8 @@ private:
         {
             return mode == AST::InterpolationTypeEnum::Enum::latch
                 || mode == AST::InterpolationTypeEnum::Enum::linear
-                || mode == AST::InterpolationTypeEnum::Enum::sinc;
+                || mode == AST::InterpolationTypeEnum::Enum::sinc
+                || mode == AST::InterpolationTypeEnum::Enum::polyphase;
         };
 
         if (isSpecificInterpolationMode (currentMode) || isSpecificInterpolationMode (newMode))
@@ -0,0 +1,129 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+namespace cmaj
+{
+
+//==============================================================================
+/// Describes the cascade of linear-phase half-band FIR filters which is used by the
+/// `polyphase` interpolation strategy to resample a stream by a power of 2.
+///
+/// Stage 0 is the one that runs between the lower rate and twice that rate. It has
+/// the narrowest transition band so gets the most taps, and each following stage
+/// only has to deal with images that are further above the audio band, so they
+/// get progressively shorter.
+///
+/// A stage with K coefficients is a (4K - 1) tap half-band filter. Every other tap
+/// of a half-band filter is zero apart from the centre one, so when it's split into
+/// its two polyphase branches, one of them is just a delay of K (or K - 1) samples,
+/// and the other is a symmetrical set of 2K taps, i.e. K multiplies per sample.
+struct HalfBandFilterCascade
+{
+    static int getNumStages (int32_t factor)
+    {
+        return static_cast<int> (0.5 + std::log (factor) / std::log (2.0));
+    }
+
+    static int getNumCoefficients (int stage)
+    {
+        return stage == 0 ? 16 : (stage == 1 ? 5 : 3);
+    }
+
+    /// Returns the K distinct coefficients for a stage, ordered so that coefficient i
+    /// is applied to (x[n - i] + x[n - (2K - 1 - i)]). They're designed with a Kaiser
+    /// window, and normalised to add up to 0.5, so the branch has unity gain at DC.
+    static std::vector<double> getCoefficients (int stage)
+    {
+        auto numCoeffs = getNumCoefficients (stage);
+        auto beta = stage == 0 ? 8.0 : 7.0;
+        auto halfLength = static_cast<double> (2 * numCoeffs);
+
+        std::vector<double> coeffs;
+        double total = 0;
+
+        for (int i = 0; i < numCoeffs; ++i)
+        {
+            // distance of this tap from the centre of the filter, which is always odd
+            auto offset = static_cast<double> (2 * (numCoeffs - i) - 1);
+            auto ratio = offset / halfLength;
+            auto window = besselI0 (beta * std::sqrt (1.0 - ratio * ratio)) / besselI0 (beta);
+            auto sinc = std::sin (offset * pi * 0.5) / (offset * pi * 0.5);
+
+            coeffs.push_back (sinc * window);
+            total += coeffs.back();
+        }
+
+        for (auto& c : coeffs)
+            c *= 0.5 / total;
+
+        return coeffs;
+    }
+
+    /// Returns the number of frames of latency (at the rate of the parent graph) which a
+    /// resampling cascade adds to a node's input or output streams.
+    static double getLatency (int32_t factor, bool isOversampledNode, bool isInput)
+    {
+        bool isUpsampling = (isInput == isOversampledNode);
+
+        // the period of the lower of the two rates, measured in frames of the parent graph
+        auto lowRatePeriod = isOversampledNode ? 1.0 : static_cast<double> (factor);
+        double latency = 0;
+
+        for (int stage = 0; stage < getNumStages (factor); ++stage)
+        {
+            // An upsampling stage delays its input by K frames. A decimating stage
+            // delays by (K - 1) frames of its output.
+            auto numCoeffs = getNumCoefficients (stage);
+            latency += (isUpsampling ? numCoeffs : numCoeffs - 1) * lowRatePeriod / (1 << stage);
+        }
+
+        // An undersampled node's input is decimated from the block of frames that
+        // ends with the one on which the node runs
+        if (isInput && ! isOversampledNode)
+            latency += factor - 1;
+
+        return latency;
+    }
+
+private:
+    static constexpr double pi = 3.141592653589793238;
+
+    static double besselI0 (double x)
+    {
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; k < 50; ++k)
+        {
+            auto t = x / (2.0 * k);
+            term *= t * t;
+            sum += term;
+
+            if (term < sum * 1.0e-12)
+                break;
+        }
+
+        return sum;
+    }
+};
+
+}
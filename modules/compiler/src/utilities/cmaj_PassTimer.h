@@ -0,0 +1,154 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+#pragma once
+
+#include "../AST/cmaj_AST.h"
+#include "../../../../include/cmajor/helpers/cmaj_PassTimings.h"
+
+namespace cmaj
+{
+
+//==============================================================================
+/// While one of these exists, any PassTimer that's created on the same thread will
+/// add its measurements to the PassTimings object that it was given.
+struct PassTimingCollector
+{
+    PassTimingCollector (PassTimings& t) : timings (t), previous (getActive())
+    {
+        getActive() = this;
+    }
+
+    ~PassTimingCollector()
+    {
+        getActive() = previous;
+    }
+
+    PassTimingCollector (const PassTimingCollector&) = delete;
+    PassTimingCollector& operator= (const PassTimingCollector&) = delete;
+
+    static PassTimingCollector*& getActive()
+    {
+        static thread_local PassTimingCollector* active = nullptr;
+        return active;
+    }
+
+    PassTimings& timings;
+    PassTimingCollector* const previous;
+};
+
+//==============================================================================
+/// Measures the time taken and the AST objects allocated during its lifetime, and
+/// adds them to the active PassTimingCollector. If there's no collector on this
+/// thread, it does nothing.
+struct PassTimer
+{
+    PassTimer (std::string_view passName, const AST::Allocator& a)
+        : collector (PassTimingCollector::getActive()), allocator (a)
+    {
+        if (collector != nullptr)
+        {
+            name = passName;
+            startObjects = allocator.numObjectsAllocated;
+            startBytes = allocator.numBytesAllocated;
+            startTime = Clock::now();
+        }
+    }
+
+    ~PassTimer()
+    {
+        if (collector != nullptr)
+        {
+            std::chrono::duration<double> elapsed = Clock::now() - startTime;
+
+            auto& pass = collector->timings.getPass (name);
+            ++pass.runs;
+            pass.seconds += elapsed.count();
+            pass.changes += numChanges;
+            pass.objectsAllocated += allocator.numObjectsAllocated - startObjects;
+            pass.bytesAllocated += allocator.numBytesAllocated - startBytes;
+
+            collector->timings.totalObjects = allocator.numObjectsAllocated;
+            collector->timings.totalBytes = allocator.numBytesAllocated;
+        }
+    }
+
+    PassTimer (const PassTimer&) = delete;
+    PassTimer& operator= (const PassTimer&) = delete;
+
+    void addChanges (size_t num)        { numChanges += num; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    PassTimingCollector* const collector;
+    const AST::Allocator& allocator;
+    std::string_view name;
+    uint64_t startObjects = 0, startBytes = 0, numChanges = 0;
+    Clock::time_point startTime;
+};
+
+//==============================================================================
+/// If there's an active PassTimingCollector, this adds a breakdown of the memory used
+/// by each class of AST object in the program, and how much of it is still reachable
+/// from the root namespace. If there's no collector on this thread, it does nothing.
+static inline void addObjectClassMemoryUsage (AST::Program& program)
+{
+    auto collector = PassTimingCollector::getActive();
+
+    if (collector == nullptr)
+        return;
+
+    struct LiveObjectCounter  : public AST::Visitor
+    {
+        LiveObjectCounter (AST::Allocator& a) : AST::Visitor (a) {}
+
+        bool shouldVisitObject (AST::Object& o) override
+        {
+            if (visited.insert (std::addressof (o)).second)
+                ++liveCounts[o.getObjectClassID()];
+
+            return true;
+        }
+
+        std::unordered_set<const AST::Object*> visited;
+        std::array<uint64_t, 256> liveCounts {};
+    };
+
+    LiveObjectCounter counter (program.allocator);
+    counter.visitObject (program.rootNamespace);
+
+    auto& timings = collector->timings;
+    timings.objectClasses.clear();
+
+    for (size_t classID = 0; classID < program.allocator.objectClassStats.size(); ++classID)
+    {
+        auto& stats = program.allocator.objectClassStats[classID];
+
+        if (stats.numObjects != 0)
+        {
+            auto& c = timings.getObjectClass (AST::getObjectClassName (static_cast<uint8_t> (classID)));
+            c.numAllocated   = stats.numObjects;
+            c.bytesAllocated = stats.numBytes;
+            c.numLive        = counter.liveCounts[classID];
+            c.bytesLive      = c.numLive * (stats.numBytes / stats.numObjects);
+        }
+    }
+}
+
+} // namespace cmaj
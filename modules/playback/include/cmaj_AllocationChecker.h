@@ -16,6 +16,8 @@
 //  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
 //  DISCLAIMED.
 
+#include <optional>
+
 #include "cmajor/API/cmaj_Performer.h"
 
 namespace cmaj
@@ -38,6 +40,10 @@ struct ScopedDisableAllocationTracking
     ~ScopedDisableAllocationTracking();
 };
 
+/// Returns the number of allocations (not counting frees) that have been made by the
+/// calling thread outside any ScopedDisableAllocationTracking.
+std::optional<size_t> getAllocationCount();
+
 #else
 
 // ==============================================================================
@@ -52,6 +58,8 @@ struct ScopedDisableAllocationTracking
     ScopedDisableAllocationTracking() {}
 };
 
+inline std::optional<size_t> getAllocationCount()   { return {}; }
+
 #endif
 
 /// If allocation checking is enabled, this will return a wrapper, otherwise
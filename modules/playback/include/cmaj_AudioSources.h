@@ -185,4 +185,236 @@ struct LoopingFilePlayerSource : public NamedAudioSource
     choc::threading::TaskThread prepareThread;
 };
 
+//==============================================================================
+/// Plays an audio file in a loop, decoding it on a background thread into a
+/// small ring buffer, so that files of any length can be played without having
+/// to load them into memory first.
+///
+/// If the file's sample rate doesn't match the rate it's prepared with, it gets
+/// resampled with linear interpolation as it's decoded. The read() callbacks never
+/// block or allocate - if the background thread falls behind, they output silence
+/// until it catches up.
+struct StreamingFilePlayerSource : public NamedAudioSource
+{
+    StreamingFilePlayerSource (std::unique_ptr<choc::audio::AudioFileReader> r)  : reader (std::move (r))
+    {
+        CMAJ_ASSERT (reader != nullptr);
+    }
+
+    ~StreamingFilePlayerSource() override
+    {
+        fillThread.stop();
+    }
+
+    std::string getName() const override  { return "file"; }
+
+    static Patch::CustomAudioSourcePtr createFromFile (const std::string& filename)
+    {
+        try
+        {
+            if (auto r = cmaj::audio_utils::createFileReader (filename))
+                if (r->getProperties().numFrames != 0 && r->getProperties().numChannels != 0)
+                    return std::make_shared<StreamingFilePlayerSource> (std::move (r));
+        }
+        catch (const std::exception&) {}
+
+        return {};
+    }
+
+    void prepare (double sampleRate) override
+    {
+        if (preparedSampleRate == sampleRate)
+            return;
+
+        // The audio thread may still be reading from the old stream, so rather than
+        // resetting it, a new one is published, and the old one is only deleted once
+        // nothing can be using it
+        fillThread.stop();
+        preparedSampleRate = sampleRate;
+
+        auto newStream = std::make_shared<Stream> (*reader, sampleRate);
+        stream.set (newStream);
+
+        fillThread.start (fillIntervalMilliseconds, [this, newStream]
+        {
+            try
+            {
+                newStream->fill (*reader);
+            }
+            catch (const std::exception&) {}
+
+            stream.releaseRetiredObjects();
+        });
+
+        fillThread.trigger();
+    }
+
+    void read (choc::buffer::InterleavedView<float> dest) override   { readAnyType (dest); }
+    void read (choc::buffer::InterleavedView<double> dest) override  { readAnyType (dest); }
+
+    template <typename Type>
+    void readAnyType (choc::buffer::InterleavedView<Type> dest)
+    {
+        RealtimeHandOver<Stream>::ScopedAccess s (stream);
+
+        if (s)
+            s->read (dest);
+        else
+            dest.clear();
+    }
+
+private:
+    static constexpr double ringLengthSeconds = 2.0;
+    static constexpr uint32_t fillIntervalMilliseconds = 20;
+    static constexpr uint32_t sourceBlockSize = 4096;
+
+    //==============================================================================
+    // Everything that depends on the sample rate. The ring is written by the background
+    // thread and read by the audio thread, and the positions are the total number of
+    // frames that have passed through it.
+    struct Stream
+    {
+        Stream (choc::audio::AudioFileReader& reader, double sampleRate)
+        {
+            auto& props = reader.getProperties();
+            auto numChannels = props.numChannels;
+
+            numSourceFrames = props.numFrames;
+            sourceFramesPerOutputFrame = props.sampleRate > 0 ? props.sampleRate / sampleRate : 1.0;
+
+            ring = choc::buffer::ChannelArrayBuffer<float> (numChannels, static_cast<uint32_t> (sampleRate * ringLengthSeconds));
+            sourceBlock = choc::buffer::ChannelArrayBuffer<float> (numChannels, sourceBlockSize);
+            previousFrame.assign (numChannels, 0.0f);
+            nextFrame.assign (numChannels, 0.0f);
+        }
+
+        template <typename Type>
+        void read (choc::buffer::InterleavedView<Type> dest)
+        {
+            if (! ready)
+            {
+                dest.clear();
+                return;
+            }
+
+            auto readPos = readPosition.load (std::memory_order_relaxed);
+            auto numAvailable = writePosition.load (std::memory_order_acquire) - readPos;
+            auto numFrames = static_cast<uint32_t> (std::min<uint64_t> (numAvailable, dest.getNumFrames()));
+
+            if (numFrames < dest.getNumFrames())
+                dest.fromFrame (numFrames).clear();
+
+            if (numFrames == 0)
+                return;
+
+            auto ringSize = ring.getNumFrames();
+            auto start = static_cast<uint32_t> (readPos % ringSize);
+            auto numBeforeWrap = std::min (numFrames, ringSize - start);
+
+            copyRemappingChannels (dest.getStart (numBeforeWrap), ring.getFrameRange ({ start, start + numBeforeWrap }));
+
+            if (numFrames > numBeforeWrap)
+                copyRemappingChannels (dest.getFrameRange ({ numBeforeWrap, numFrames }), ring.getStart (numFrames - numBeforeWrap));
+
+            readPosition.store (readPos + numFrames, std::memory_order_release);
+        }
+
+        void fill (choc::audio::AudioFileReader& reader)
+        {
+            if (! started)
+            {
+                if (! (readNextSourceFrame (reader, previousFrame) && readNextSourceFrame (reader, nextFrame)))
+                    return;
+
+                started = true;
+            }
+
+            auto ringSize = ring.getNumFrames();
+            auto numChannels = ring.getNumChannels();
+
+            for (;;)
+            {
+                auto writePos = writePosition.load (std::memory_order_relaxed);
+                auto numFree = ringSize - static_cast<uint32_t> (writePos - readPosition.load (std::memory_order_acquire));
+
+                if (numFree == 0)
+                    break;
+
+                auto start = static_cast<uint32_t> (writePos % ringSize);
+                auto numToWrite = std::min ({ numFree, ringSize - start, sourceBlockSize });
+
+                for (uint32_t i = 0; i < numToWrite; ++i)
+                {
+                    auto frac = static_cast<float> (fraction);
+
+                    for (uint32_t chan = 0; chan < numChannels; ++chan)
+                        ring.getSample (chan, start + i) = previousFrame[chan] + (nextFrame[chan] - previousFrame[chan]) * frac;
+
+                    fraction += sourceFramesPerOutputFrame;
+
+                    while (fraction >= 1.0)
+                    {
+                        fraction -= 1.0;
+                        std::swap (previousFrame, nextFrame);
+
+                        if (! readNextSourceFrame (reader, nextFrame))
+                        {
+                            writePosition.store (writePos + i + 1, std::memory_order_release);
+                            ready = true;
+                            return;
+                        }
+                    }
+                }
+
+                writePosition.store (writePos + numToWrite, std::memory_order_release);
+                ready = true;
+            }
+        }
+
+        choc::buffer::ChannelArrayBuffer<float> ring;
+        std::atomic<uint64_t> readPosition { 0 }, writePosition { 0 };
+        std::atomic<bool> ready { false };
+
+    private:
+        // Everything below here is only touched by the background thread
+        bool started = false;
+        choc::buffer::ChannelArrayBuffer<float> sourceBlock;
+        uint32_t sourceBlockFrames = 0, sourceBlockIndex = 0;
+        uint64_t numSourceFrames = 0, nextSourceFrame = 0;
+        std::vector<float> previousFrame, nextFrame;
+        double sourceFramesPerOutputFrame = 1.0, fraction = 0;
+
+        bool readNextSourceFrame (choc::audio::AudioFileReader& reader, std::vector<float>& frame)
+        {
+            if (sourceBlockIndex == sourceBlockFrames)
+            {
+                if (nextSourceFrame >= numSourceFrames)
+                    nextSourceFrame = 0;
+
+                auto numToRead = static_cast<uint32_t> (std::min<uint64_t> (sourceBlock.getNumFrames(), numSourceFrames - nextSourceFrame));
+
+                if (! reader.readFrames (nextSourceFrame, sourceBlock.getStart (numToRead)))
+                    return false;
+
+                nextSourceFrame += numToRead;
+                sourceBlockFrames = numToRead;
+                sourceBlockIndex = 0;
+            }
+
+            for (uint32_t chan = 0; chan < frame.size(); ++chan)
+                frame[chan] = sourceBlock.getSample (chan, sourceBlockIndex);
+
+            ++sourceBlockIndex;
+            return true;
+        }
+    };
+
+    // The reader is only used by the background thread, which is stopped before each new
+    // stream is created
+    std::unique_ptr<choc::audio::AudioFileReader> reader;
+    choc::threading::TaskThread fillThread;
+    double preparedSampleRate = 0;
+    RealtimeHandOver<Stream> stream;
+};
+
 } // namespace cmaj::audio_utils
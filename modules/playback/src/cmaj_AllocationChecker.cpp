@@ -45,29 +45,35 @@ namespace cmaj
     ScopedDisableAllocationTracking::ScopedDisableAllocationTracking()  { disableAllocationTracker++; }
     ScopedDisableAllocationTracking::~ScopedDisableAllocationTracking() { disableAllocationTracker--; }
 
-    static void checkAllocationAllowed()
+    std::optional<size_t> getAllocationCount()    { return allocationCount.allocations; }
+
+    static bool checkAllocationAllowed()
     {
-        if (cmaj::disableAllocationTracker == 0)
-        {
-            if (cmaj::throwOnAllocation != 0)
-            {
-                cmaj::disableAllocationTracker++;
-                CMAJ_ASSERT (cmaj::throwOnAllocation == 0);
-            }
+        if (cmaj::disableAllocationTracker != 0)
+            return false;
 
-            cmaj::allocationCount.allocations++;
+        if (cmaj::throwOnAllocation != 0)
+        {
+            cmaj::disableAllocationTracker++;
+            CMAJ_ASSERT (cmaj::throwOnAllocation == 0);
         }
+
+        return true;
     }
 
     void* performNew (std::size_t size)
     {
-        checkAllocationAllowed();
+        if (checkAllocationAllowed())
+            cmaj::allocationCount.allocations++;
+
         return std::malloc (size);
     }
 
     void performDelete (void* p) noexcept
     {
-        checkAllocationAllowed();
+        if (checkAllocationAllowed())
+            cmaj::allocationCount.frees++;
+
         std::free (p);
     }
 }
@@ -290,6 +290,8 @@ private:
 
     std::vector<const float*> flattenedInputChannelsScratchBuffer;
     std::vector<float*> flattenedOutputChannelsScratchBuffer;
+    std::vector<const double*> flattenedInputChannelsScratchBuffer64;
+    std::vector<double*> flattenedOutputChannelsScratchBuffer64;
 
     double frequency = 0;
     uint32_t maxBlockSize = 0;
@@ -432,6 +434,8 @@ private:
 
         flattenedInputChannelsScratchBuffer.resize (sumTotalChannelsAcrossAudioEndpoints (patch.getInputEndpoints()));
         flattenedOutputChannelsScratchBuffer.resize (sumTotalChannelsAcrossAudioEndpoints (patch.getOutputEndpoints()));
+        flattenedInputChannelsScratchBuffer64.resize (flattenedInputChannelsScratchBuffer.size());
+        flattenedOutputChannelsScratchBuffer64.resize (flattenedOutputChannelsScratchBuffer.size());
 
         return true;
     }
@@ -670,10 +674,21 @@ inline void Plugin::Impl::updateAudioPortInfoCachesFromLoadedPatch()
             return nullptr;
         };
 
-        const auto toFlags = [] (uint32_t index, const cmaj::EndpointDetails&) -> uint32_t
+        const auto toFlags = [] (uint32_t index, const cmaj::EndpointDetails& endpoint) -> uint32_t
         {
             // for now, first endpoint is implicitly main. there can only be one, and it must be index 0
-            return index == 0 ? CLAP_AUDIO_PORT_IS_MAIN : 0;
+            uint32_t flags = index == 0 ? CLAP_AUDIO_PORT_IS_MAIN : 0;
+
+            // all ports can be processed at either precision, but float64 endpoints avoid any conversion in 64-bit.
+            // We render a whole block at one precision, so the host must use the same sample size for every port.
+            flags |= CLAP_AUDIO_PORT_SUPPORTS_64BITS | CLAP_AUDIO_PORT_REQUIRES_COMMON_SAMPLE_SIZE;
+
+            const auto& type = endpoint.dataTypes.front();
+
+            if (type.isFloat64() || (type.isVector() && type.getElementType().isFloat64()))
+                flags |= CLAP_AUDIO_PORT_PREFERS_64BITS;
+
+            return flags;
         };
 
         uint32_t indexId = 0;
@@ -688,7 +703,7 @@ inline void Plugin::Impl::updateAudioPortInfoCachesFromLoadedPatch()
                 port.channel_count = channelCount;
                 port.flags = toFlags (indexId, endpoint);
                 port.port_type = toPortType (channelCount);
-                port.in_place_pair = CLAP_INVALID_ID; // we don't currently support in-place processing
+                port.in_place_pair = CLAP_INVALID_ID; // assigned below, once both lists are known
 
                 infoForPortsToAppendTo.push_back (port);
 
@@ -709,6 +724,20 @@ inline void Plugin::Impl::updateAudioPortInfoCachesFromLoadedPatch()
     {
         mapEndpointsToPorts (patch.getInputEndpoints(), infoForInputAudioPorts);
         mapEndpointsToPorts (patch.getOutputEndpoints(), infoForOutputAudioPorts);
+
+        // The performer consumes all of its inputs before writing any outputs, so input and output
+        // ports at the same position with matching channel counts can share their buffers
+        for (size_t i = 0; i < std::min (infoForInputAudioPorts.size(), infoForOutputAudioPorts.size()); ++i)
+        {
+            auto& input = infoForInputAudioPorts[i];
+            auto& output = infoForOutputAudioPorts[i];
+
+            if (input.channel_count == output.channel_count)
+            {
+                input.in_place_pair = output.id;
+                output.in_place_pair = input.id;
+            }
+        }
     }
     else
     {
@@ -856,7 +885,6 @@ inline clap_process_status Plugin::Impl::clapPlugin_process (const clap_process_
 
         const auto toChannelArrayView = [] (auto& scratch, const auto& portInfos, auto* clapBuffers, auto blockSize)
         {
-            // currently only handling single precision, i.e. data32. when setting up the audio ports we don't set any 64 bit flags.
             const auto populateFlattenedChannelsScatchBuffer = [] (auto& flattened, const auto& info, auto* buffers)
             {
                 size_t flattenedChannelsIndex = 0;
@@ -867,7 +895,12 @@ inline clap_process_status Plugin::Impl::clapPlugin_process (const clap_process_
                     const auto channelCount = info[i].channel_count;
 
                     for (uint32_t channel = 0; channel < channelCount; ++channel)
-                        flattened[flattenedChannelsIndex++] = buffer.data32[channel];
+                    {
+                        if constexpr (std::is_same_v<std::remove_const_t<std::remove_pointer_t<typename std::decay_t<decltype (flattened)>::value_type>>, double>)
+                            flattened[flattenedChannelsIndex++] = buffer.data64[channel];
+                        else
+                            flattened[flattenedChannelsIndex++] = buffer.data32[channel];
+                    }
                 }
             };
 
@@ -876,67 +909,94 @@ inline clap_process_status Plugin::Impl::clapPlugin_process (const clap_process_
             return choc::buffer::createChannelArrayView (scratch.data(), static_cast<uint32_t> (scratch.size()), blockSize);
         };
 
-        auto inputChannels = toChannelArrayView (flattenedInputChannelsScratchBuffer, infoForInputAudioPorts, inputs, count);
-        auto outputChannels = toChannelArrayView (flattenedOutputChannelsScratchBuffer, infoForOutputAudioPorts, outputs, count);
-
-        forEachFilteredEventRange ({ 0, count },
-                                   inputQueue,
-                                   shouldConsumeEvent,
-                                   [this] (const auto& event) { dispatchEvent (event); },
-                                   [&] (const auto& range)
+        // We flag every port as supporting 64-bit and requiring a common sample size, so a host which
+        // chooses double precision will provide data64 for all of them, and we can render the whole
+        // block at that precision.
+        const auto hostProvidedDoublePrecision = [] (const auto& portInfos, auto* clapBuffers)
         {
-            const bool replaceOutput = true;
+            for (size_t i = 0; i < portInfos.size(); ++i)
+                if (portInfos[i].channel_count != 0 && clapBuffers[i].data64 == nullptr)
+                    return false;
 
-            patch.process ({
-                inputChannels.getFrameRange ({ range.start, range.end }),
-                outputChannels.getFrameRange ({ range.start, range.end }),
-                choc::span<choc::midi::ShortMessage> {}, // handle splitting events externally, for sample-accurate automation etc.
-                [&, this] (auto frameIndex, const auto& message)
-                {
-                    if (infoForOutputNotePorts.empty())
-                        return;
+            return true;
+        };
 
-                    const uint16_t portIndex = 0;
-                    const auto frameOffsetRelativeToProcessBlockStart = range.start + frameIndex;
+        const auto useDoublePrecision = (! infoForInputAudioPorts.empty() || ! infoForOutputAudioPorts.empty())
+                                          && hostProvidedDoublePrecision (infoForInputAudioPorts, inputs)
+                                          && hostProvidedDoublePrecision (infoForOutputAudioPorts, outputs);
 
-                    const auto pushClapMidiEvent = [&]
-                    {
-                        const auto clapEvent = toClapMidiEvent (
-                            frameOffsetRelativeToProcessBlockStart,
-                            portIndex,
-                            message
-                        );
+        const auto processChannels = [&] (auto inputChannels, auto outputChannels)
+        {
+            using BlockType = std::conditional_t<std::is_same_v<decltype (outputChannels), choc::buffer::ChannelArrayView<double>>,
+                                                 cmaj::AudioMIDIPerformer::DoublePrecisionBlock,
+                                                 choc::audio::AudioMIDIBlockDispatcher::Block>;
+
+            forEachFilteredEventRange ({ 0, count },
+                                       inputQueue,
+                                       shouldConsumeEvent,
+                                       [this] (const auto& event) { dispatchEvent (event); },
+                                       [&] (const auto& range)
+            {
+                const bool replaceOutput = true;
 
-                        outputQueue.try_push (std::addressof (outputQueue), std::addressof (clapEvent.header));
-                    };
+                patch.process (BlockType {
+                    inputChannels.getFrameRange ({ range.start, range.end }),
+                    outputChannels.getFrameRange ({ range.start, range.end }),
+                    choc::span<choc::midi::ShortMessage> {}, // handle splitting events externally, for sample-accurate automation etc.
+                    [&, this] (auto frameIndex, const auto& message)
+                    {
+                        if (infoForOutputNotePorts.empty())
+                            return;
 
-                    // prefer MIDI if host supports it
-                    if (hostSupportedNotePortDialects & CLAP_NOTE_DIALECT_MIDI)
-                        return pushClapMidiEvent();
+                        const uint16_t portIndex = 0;
+                        const auto frameOffsetRelativeToProcessBlockStart = range.start + frameIndex;
 
-                    if (hostSupportedNotePortDialects & CLAP_NOTE_DIALECT_CLAP)
-                    {
-                        if (message.isNoteOn() || message.isNoteOff())
+                        const auto pushClapMidiEvent = [&]
                         {
-                            const auto clapEvent = toClapNoteEvent (
+                            const auto clapEvent = toClapMidiEvent (
                                 frameOffsetRelativeToProcessBlockStart,
                                 portIndex,
-                                static_cast<uint16_t> (message.isNoteOn() ? CLAP_EVENT_NOTE_ON : CLAP_EVENT_NOTE_OFF),
-                                message.getChannel0to15(),
-                                message.getNoteNumber(),
-                                message.getVelocity() / 127.0
+                                message
                             );
 
                             outputQueue.try_push (std::addressof (outputQueue), std::addressof (clapEvent.header));
-                            return;
+                        };
+
+                        // prefer MIDI if host supports it
+                        if (hostSupportedNotePortDialects & CLAP_NOTE_DIALECT_MIDI)
+                            return pushClapMidiEvent();
+
+                        if (hostSupportedNotePortDialects & CLAP_NOTE_DIALECT_CLAP)
+                        {
+                            if (message.isNoteOn() || message.isNoteOff())
+                            {
+                                const auto clapEvent = toClapNoteEvent (
+                                    frameOffsetRelativeToProcessBlockStart,
+                                    portIndex,
+                                    static_cast<uint16_t> (message.isNoteOn() ? CLAP_EVENT_NOTE_ON : CLAP_EVENT_NOTE_OFF),
+                                    message.getChannel0to15(),
+                                    message.getNoteNumber(),
+                                    message.getVelocity() / 127.0
+                                );
+
+                                outputQueue.try_push (std::addressof (outputQueue), std::addressof (clapEvent.header));
+                                return;
+                            }
                         }
+
+                        // just map to midi and hope the host can do something with it
+                        return pushClapMidiEvent();
                     }
+                }, replaceOutput);
+            });
+        };
 
-                    // just map to midi and hope the host can do something with it
-                    return pushClapMidiEvent();
-                }
-            }, replaceOutput);
-        });
+        if (useDoublePrecision)
+            processChannels (toChannelArrayView (flattenedInputChannelsScratchBuffer64, infoForInputAudioPorts, inputs, count),
+                             toChannelArrayView (flattenedOutputChannelsScratchBuffer64, infoForOutputAudioPorts, outputs, count));
+        else
+            processChannels (toChannelArrayView (flattenedInputChannelsScratchBuffer, infoForInputAudioPorts, inputs, count),
+                             toChannelArrayView (flattenedOutputChannelsScratchBuffer, infoForOutputAudioPorts, outputs, count));
     };
 
     consumeEventsFromEditor (*process->out_events);
@@ -21,6 +21,7 @@
 #include "../../compiler/include/cmaj_ErrorHandling.h"
 #include "choc/javascript/choc_javascript.h"
 #include "../../../include/cmajor/helpers/cmaj_Patch.h"
+#include "../../../include/cmajor/helpers/cmaj_PassTimings.h"
 #include "../../playback/include/cmaj_AudioMIDIPlayer.h"
 
 
@@ -42,6 +43,10 @@ namespace cmaj::javascript
         void resetPerformerLibrary();
         std::string getEngineTypeName();
 
+        /// Returns the combined pass timings of all the engines that have been
+        /// linked, if the timePasses build setting is enabled.
+        const PassTimings& getPassTimings();
+
     private:
         struct Pimpl;
         std::unique_ptr<Pimpl> pimpl;
@@ -106,4 +106,9 @@ std::string JavascriptEngine::getEngineTypeName()
     return pimpl->performerLibrary.getEngineTypeName();
 }
 
+const PassTimings& JavascriptEngine::getPassTimings()
+{
+    return pimpl->performerLibrary.passTimings;
+}
+
 }
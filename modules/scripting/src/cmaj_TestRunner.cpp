@@ -240,6 +240,9 @@ namespace cmaj::test
         std::chrono::duration<double> time;
         std::vector<TestCase> tests;
 
+        PassTimings passTimings;
+        std::mutex passTimingsLock;
+
     private:
         void addTest (TestSection ts)
         {
@@ -999,6 +1002,12 @@ function getEngineName()                             { return _getEngineName();
 
             testEngine.runTest (std::addressof (console), test, runDisabled);
         }
+
+        if (buildSettings.shouldTimePasses())
+        {
+            std::lock_guard<std::mutex> lock (passTimingsLock);
+            passTimings.merge (testEngine.javascriptEngine->getPassTimings());
+        }
     }
 
     //==============================================================================
@@ -1192,6 +1201,18 @@ function getEngineName()                             { return _getEngineName();
             totalResults = TestResult::getTotal (testSuites);
             totalResults.printSummary (output);
 
+            if (buildSettings.shouldTimePasses())
+            {
+                PassTimings passTimings;
+
+                for (auto& suite : testSuites)
+                    passTimings.merge (suite->passTimings);
+
+                output << "Compiler pass timings:" << std::endl
+                       << std::endl
+                       << passTimings.toTable() << std::endl;
+            }
+
             if (printOnlyErrors)
             {
                 for (auto& suite : testSuites)
@@ -512,6 +512,57 @@ static constexpr std::string_view testFunctionLibrary = "//\n"
     "}\n"
     "\n"
     "//==============================================================================\n"
+    "/**\n"
+    "    This test compiles and links the code, and then checks that each of the expected\n"
+    "    strings matches a whole line of the engine's build log. The log is plain text,\n"
+    "    and leading and trailing whitespace on each line is ignored.\n"
+    "\n"
+    "    e.g.\n"
+    "    ## testBuildLog (\"Event delay queue for Test._delay1: 16 events, 128 bytes\")\n"
+    "    ## testBuildLog ([\"first line\", \"second line\"], { optimiseStateLayout: true })\n"
+    "*/\n"
+    "function testBuildLog (expectedText, options)\n"
+    "{\n"
+    "    let testSection = getCurrentTestSection();\n"
+    "    let engine = buildEngineWithLoadedProgram (testSection, options, {});\n"
+    "\n"
+    "    if (isError (engine, options))\n"
+    "    {\n"
+    "        testSection.reportFail (engine);\n"
+    "        return;\n"
+    "    }\n"
+    "\n"
+    "    let error = engine.link();\n"
+    "\n"
+    "    if (isError (error, options))\n"
+    "    {\n"
+    "        testSection.reportFail (error);\n"
+    "        return;\n"
+    "    }\n"
+    "\n"
+    "    let log = engine.getLastBuildLog();\n"
+    "    let lines = log.split (\"\\n\");\n"
+    "\n"
+    "    for (let i = 0; i < lines.length; ++i)\n"
+    "        lines[i] = lines[i].trim();\n"
+    "\n"
+    "    if (! Array.isArray (expectedText))\n"
+    "        expectedText = [expectedText];\n"
+    "\n"
+    "    for (let i = 0; i < expectedText.length; ++i)\n"
+    "    {\n"
+    "        if (! lines.includes (expectedText[i]))\n"
+    "        {\n"
+    "            testSection.logMessage (\"Build log:\\n\" + log);\n"
+    "            testSection.reportFail (\"Expected the build log to contain the line '\" + expectedText[i] + \"'\");\n"
+    "            return;\n"
+    "        }\n"
+    "    }\n"
+    "\n"
+    "    testSection.reportSuccess();\n"
+    "}\n"
+    "\n"
+    "//==============================================================================\n"
     "/* This test checks whether the console output matches what was expected\n"
     "\n"
     "    e.g.\n"
@@ -622,6 +673,24 @@ static constexpr std::string_view testFunctionLibrary = "//\n"
     "    e.g.\n"
     "    ## performanceTest ({ frequency:44100, minBlockSize:4, maxBlockSize: 1024, samplesToRender:100000 })\n"
     "    ## performanceTest ({ frequency:44100, minBlockSize:4, maxBlockSize: 1024, samplesToRender:100000, patch: \"testPatch.cmajorpatch\" })\n"
+    "\n"
+    "    If a `repetitions` property is supplied, the test runs in benchmark mode: each block size is\n"
+    "    warmed up and then rendered the given number of times, and the min/median/p95 cost per frame\n"
+    "    (in nanoseconds, and in instructions where the platform can count them) is reported.\n"
+    "    Any output events are read after each block, as a host would, and if the allocation\n"
+    "    checker is enabled, the test fails if rendering allocates any memory.\n"
+    "    Other benchmark options are:\n"
+    "\n"
+    "      warmUpFrames          - frames rendered before measuring (defaults to samplesToRender)\n"
+    "      stimulus              - the input signal: \"ramp\" (default), \"noise\", \"sine\" or \"silence\"\n"
+    "      resultsFile           - a .json file to which the results are written\n"
+    "      baselineFile          - a .json file of earlier results to compare against. If it doesn't\n"
+    "                              exist, it will be created from the current results\n"
+    "      maxRegressionPercent  - how much slower than the baseline median a block size may be\n"
+    "                              before the test fails (defaults to 10)\n"
+    "\n"
+    "    e.g.\n"
+    "    ## performanceTest ({ frequency:44100, minBlockSize:32, maxBlockSize: 512, samplesToRender:65536, repetitions:20, baselineFile: \"baseline.json\" })\n"
     "*/\n"
     "\n"
     "function performanceTest (options)\n"
@@ -684,6 +753,13 @@ static constexpr std::string_view testFunctionLibrary = "//\n"
     "    testSection.logMessage (\"Total     : \" + Math.round (totalTime * 1000) + \" ms\");\n"
     "\n"
     "    let performer = engine.createPerformer();\n"
+    "\n"
+    "    if (options.repetitions !== undefined)\n"
+    "    {\n"
+    "        runPerformanceBenchmark (testSection, options, performer, inputEndpoints, outputEndpoints);\n"
+    "        return;\n"
+    "    }\n"
+    "\n"
     "    let blockSize = options.minBlockSize;\n"
     "    let inputFrames = [];\n"
     "\n"
@@ -713,6 +789,227 @@ static constexpr std::string_view testFunctionLibrary = "//\n"
     "    testSection.reportSuccess();\n"
     "}\n"
     "\n"
+    "function createBenchmarkStimulus (type, numFrames)\n"
+    "{\n"
+    "    let frames = [];\n"
+    "    let seed = 12345;\n"
+    "\n"
+    "    for (let i = 0; i < numFrames; i++)\n"
+    "    {\n"
+    "        if (type == \"silence\")      frames[i] = 0;\n"
+    "        else if (type == \"sine\")    frames[i] = Math.sin (i * 0.0628);\n"
+    "        else if (type == \"noise\")   { seed = (seed * 1103515245 + 12345) % 2147483648; frames[i] = seed / 1073741824 - 1.0; }\n"
+    "        else                        frames[i] = i / numFrames;\n"
+    "    }\n"
+    "\n"
+    "    return frames;\n"
+    "}\n"
+    "\n"
+    "function runPerformanceBenchmark (testSection, options, performer, inputEndpoints, outputEndpoints)\n"
+    "{\n"
+    "    let stimulus = createBenchmarkStimulus (options.stimulus, options.maxBlockSize);\n"
+    "    let maxRegressionPercent = options.maxRegressionPercent !== undefined ? options.maxRegressionPercent : 10;\n"
+    "    let results = { engine: getEngineName(), frequency: options.frequency, blockSizes: [] };\n"
+    "    let inputs = [];\n"
+    "\n"
+    "    for (let i = 0; i < inputEndpoints.length; i++)\n"
+    "        if (inputEndpoints[i].endpointType == \"stream\")\n"
+    "            inputs.push ({ handle: inputEndpoints[i].handle, frames: stimulus });\n"
+    "\n"
+    "    let outputEvents = [];\n"
+    "\n"
+    "    for (let i = 0; i < outputEndpoints.length; i++)\n"
+    "        if (outputEndpoints[i].endpointType == \"event\")\n"
+    "            outputEvents.push (outputEndpoints[i].handle);\n"
+    "\n"
+    "    for (let blockSize = options.minBlockSize; blockSize <= options.maxBlockSize; blockSize *= 2)\n"
+    "    {\n"
+    "        let result = performer.benchmarkRenderPerformance ({ blockSize: blockSize,\n"
+    "                                                             framesPerRepetition: options.samplesToRender,\n"
+    "                                                             warmUpFrames: options.warmUpFrames !== undefined ? options.warmUpFrames : options.samplesToRender,\n"
+    "                                                             repetitions: options.repetitions,\n"
+    "                                                             inputs: inputs,\n"
+    "                                                             outputEvents: outputEvents });\n"
+    "\n"
+    "        if (isError (result))\n"
+    "        {\n"
+    "            testSection.reportFail (result);\n"
+    "            return;\n"
+    "        }\n"
+    "\n"
+    "        let nsPerFrame = result.nsPerFrame;\n"
+    "        let utilisation = 100.0 * options.frequency * nsPerFrame.median * 1.0e-9;\n"
+    "        let message = \"Block size \" + blockSize + \", ns/frame min \" + nsPerFrame.min.toFixed (2)\n"
+    "                        + \" median \" + nsPerFrame.median.toFixed (2) + \" p95 \" + nsPerFrame.p95.toFixed (2);\n"
+    "\n"
+    "        if (result.instructionsPerFrame !== undefined)\n"
+    "            message += \", instructions/frame median \" + result.instructionsPerFrame.median.toFixed (1);\n"
+    "\n"
+    "        if (result.eventsPerBlock !== undefined)\n"
+    "            message += \", events/block \" + result.eventsPerBlock.toFixed (1);\n"
+    "\n"
+    "        if (result.allocationsPerBlock !== undefined)\n"
+    "            message += \", allocations/block \" + result.allocationsPerBlock.toFixed (2);\n"
+    "\n"
+    "        testSection.logMessage (message + \", utilisation = \" + utilisation.toFixed (2));\n"
+    "        results.blockSizes.push (result);\n"
+    "\n"
+    "        if (result.allocationsPerBlock !== undefined && result.allocationsPerBlock > 0)\n"
+    "        {\n"
+    "            testSection.reportFail (\"Rendering allocated memory\");\n"
+    "            return;\n"
+    "        }\n"
+    "    }\n"
+    "\n"
+    "    if (options.resultsFile !== undefined)\n"
+    "        testSection.writeEventData (options.resultsFile, results);\n"
+    "\n"
+    "    if (options.baselineFile !== undefined)\n"
+    "    {\n"
+    "        let baseline = testSection.readEventData (options.baselineFile);\n"
+    "\n"
+    "        if (baseline === undefined || isError (baseline))\n"
+    "        {\n"
+    "            testSection.logMessage (\"Can't find baseline file \" + options.baselineFile + \" - write it\");\n"
+    "            testSection.writeEventData (options.baselineFile, results);\n"
+    "        }\n"
+    "        else\n"
+    "        {\n"
+    "            let regressions = 0;\n"
+    "\n"
+    "            for (let i = 0; i < results.blockSizes.length; i++)\n"
+    "            {\n"
+    "                let current = results.blockSizes[i];\n"
+    "\n"
+    "                for (let j = 0; j < baseline.blockSizes.length; j++)\n"
+    "                {\n"
+    "                    let previous = baseline.blockSizes[j];\n"
+    "\n"
+    "                    if (previous.blockSize != current.blockSize)\n"
+    "                        continue;\n"
+    "\n"
+    "                    let changePercent = 100.0 * (current.nsPerFrame.median - previous.nsPerFrame.median) / previous.nsPerFrame.median;\n"
+    "\n"
+    "                    if (changePercent > maxRegressionPercent)\n"
+    "                    {\n"
+    "                        testSection.logMessage (\"Block size \" + current.blockSize + \" is \" + changePercent.toFixed (1)\n"
+    "                                                  + \"% slower than the baseline median of \" + previous.nsPerFrame.median.toFixed (2) + \" ns/frame\");\n"
+    "                        ++regressions;\n"
+    "                    }\n"
+    "                }\n"
+    "            }\n"
+    "\n"
+    "            if (regressions != 0)\n"
+    "            {\n"
+    "                testSection.reportFail (\"performance regression\");\n"
+    "                return;\n"
+    "            }\n"
+    "        }\n"
+    "    }\n"
+    "\n"
+    "    testSection.reportSuccess();\n"
+    "}\n"
+    "\n"
+    "//==============================================================================\n"
+    "/*\n"
+    "    This test checks that the time taken to compile a graph grows roughly linearly\n"
+    "    with its size. For each of the given sizes, it generates a main graph made of that\n"
+    "    many columns of `width` nodes, where every node in a column is connected to every\n"
+    "    node in the previous one, so the number of paths through the graph grows\n"
+    "    exponentially with its size. Each node is an instance of a processor called Stage,\n"
+    "    which the test's source must declare, with a stream input `in` and output `out`.\n"
+    "\n"
+    "    The test fails if the time for the largest graph, divided by its size, is more\n"
+    "    than maxRatio (defaulting to 4) times the same figure for the smallest one.\n"
+    "\n"
+    "    e.g.\n"
+    "    ## compileScalingTest ({ sizes: [25, 50, 100, 200], width: 4 })\n"
+    "*/\n"
+    "function compileScalingTest (options)\n"
+    "{\n"
+    "    let testSection = getCurrentTestSection();\n"
+    "    let width = options.width !== undefined ? options.width : 4;\n"
+    "    let maxRatio = options.maxRatio !== undefined ? options.maxRatio : 4;\n"
+    "    let timesPerColumn = [];\n"
+    "\n"
+    "    for (let size of options.sizes)\n"
+    "    {\n"
+    "        let engine = createEngine (options);\n"
+    "        updateBuildSettings (engine, options.frequency, options.blockSize, false, options);\n"
+    "\n"
+    "        let program = new Program();\n"
+    "        let parseResult = program.parse (testSection.source + createScalingTestGraph (size, width) + testSection.globalSource);\n"
+    "\n"
+    "        if (isError (parseResult))\n"
+    "        {\n"
+    "            testSection.reportFail (parseResult);\n"
+    "            return;\n"
+    "        }\n"
+    "\n"
+    "        let loadTime = engine.load (program);\n"
+    "\n"
+    "        if (isError (loadTime))\n"
+    "        {\n"
+    "            testSection.reportFail (loadTime);\n"
+    "            return;\n"
+    "        }\n"
+    "\n"
+    "        let linkTime = engine.link();\n"
+    "\n"
+    "        if (isError (linkTime))\n"
+    "        {\n"
+    "            testSection.reportFail (linkTime);\n"
+    "            return;\n"
+    "        }\n"
+    "\n"
+    "        let totalTime = loadTime + linkTime;\n"
+    "        timesPerColumn.push (totalTime / size);\n"
+    "\n"
+    "        testSection.logMessage (\"Columns: \" + size + \", nodes: \" + (size * width) + \", load + link time: \"\n"
+    "                                  + Math.round (totalTime * 1000) + \" ms\");\n"
+    "    }\n"
+    "\n"
+    "    let ratio = timesPerColumn[timesPerColumn.length - 1] / timesPerColumn[0];\n"
+    "    testSection.logMessage (\"Time per column, largest vs smallest graph: \" + ratio.toFixed (2));\n"
+    "\n"
+    "    if (ratio > maxRatio)\n"
+    "    {\n"
+    "        testSection.reportFail (\"Compile time grows faster than the size of the graph\");\n"
+    "        return;\n"
+    "    }\n"
+    "\n"
+    "    testSection.reportSuccess();\n"
+    "}\n"
+    "\n"
+    "function createScalingTestGraph (numColumns, width)\n"
+    "{\n"
+    "    let nodes = \"\", connections = \"\";\n"
+    "    let nodeName = (column, row) => \"n\" + column + \"_\" + row;\n"
+    "\n"
+    "    for (let column = 0; column < numColumns; column++)\n"
+    "    {\n"
+    "        for (let row = 0; row < width; row++)\n"
+    "        {\n"
+    "            nodes += \"    node \" + nodeName (column, row) + \" = Stage;\\n\";\n"
+    "\n"
+    "            if (column == 0)\n"
+    "                connections += \"        in -> \" + nodeName (column, row) + \".in;\\n\";\n"
+    "            else\n"
+    "                for (let source = 0; source < width; source++)\n"
+    "                    connections += \"        \" + nodeName (column - 1, source) + \".out -> \" + nodeName (column, row) + \".in;\\n\";\n"
+    "\n"
+    "            if (column == numColumns - 1)\n"
+    "                connections += \"        \" + nodeName (column, row) + \".out -> out;\\n\";\n"
+    "        }\n"
+    "    }\n"
+    "\n"
+    "    return \"\\ngraph Generated [[ main ]]\\n{\\n\"\n"
+    "            + \"    input stream float in;\\n\"\n"
+    "            + \"    output stream float out;\\n\\n\"\n"
+    "            + nodes\n"
+    "            + \"\\n    connection\\n    {\\n\" + connections + \"    }\\n}\\n\";\n"
+    "}\n"
+    "\n"
     "//==============================================================================\n"
     "/*\n"
     "    This test takes the filename of a .cmajorpatch and tries to build it, failing\n"
@@ -1244,6 +1541,9 @@ static constexpr std::string_view testFunctionLibrary = "//\n"
     "        if (options.sessionID !== undefined)          buildSettings.sessionID = options.sessionID;\n"
     "        if (options.optimisationLevel !== undefined)  buildSettings.optimisationLevel = options.optimisationLevel;\n"
     "        if (options.mainProcessor !== undefined)      buildSettings.mainProcessor = options.mainProcessor;\n"
+    "        if (options.optimiseStateLayout !== undefined) buildSettings.optimiseStateLayout = options.optimiseStateLayout;\n"
+    "        if (options.packNodeArrays !== undefined)      buildSettings.packNodeArrays = options.packNodeArrays;\n"
+    "        if (options.approximateMaths !== undefined)    buildSettings.approximateMaths = options.approximateMaths;\n"
     "    }\n"
     "\n"
     "    engine.setBuildSettings (buildSettings);\n"
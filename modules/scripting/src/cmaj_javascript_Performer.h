@@ -18,8 +18,10 @@
 
 #include "../../../include/cmajor/API/cmaj_Engine.h"
 #include "../../../include/cmajor/helpers/cmaj_EndpointTypeCoercion.h"
+#include "../../../include/cmajor/helpers/cmaj_PassTimings.h"
 #include "../../../modules/playback/include/cmaj_AllocationChecker.h"
 #include "../../../modules/compiler/src/transformations/cmaj_Transformations.h"
+#include "cmaj_javascript_RenderBenchmark.h"
 
 namespace cmaj::javascript
 {
@@ -91,6 +93,7 @@ struct PerformerLibrary
         CMAJ_JAVASCRIPT_BINDING_METHOD (engineLink)
         CMAJ_JAVASCRIPT_BINDING_METHOD (engineIsLoaded)
         CMAJ_JAVASCRIPT_BINDING_METHOD (engineIsLinked)
+        CMAJ_JAVASCRIPT_BINDING_METHOD (engineGetLastBuildLog)
         CMAJ_JAVASCRIPT_BINDING_METHOD (engineCreatePerformer)
         CMAJ_JAVASCRIPT_BINDING_METHOD (engineGetAvailableCodeGenTargetTypes)
         CMAJ_JAVASCRIPT_BINDING_METHOD (engineGenerateCode)
@@ -107,6 +110,7 @@ struct PerformerLibrary
         CMAJ_JAVASCRIPT_BINDING_METHOD (performerAddInputEvent)
         CMAJ_JAVASCRIPT_BINDING_METHOD (performerGetXRuns)
         CMAJ_JAVASCRIPT_BINDING_METHOD (performerCalculateRenderPerformance)
+        CMAJ_JAVASCRIPT_BINDING_METHOD (performerBenchmarkRenderPerformance)
     }
 
     void reset()
@@ -357,6 +361,148 @@ private:
             return choc::value::Value (elapsed.count());
         }
 
+        /// Runs a render benchmark, returning per-frame timing (and where possible, instruction count)
+        /// statistics over a number of repetitions. The options object may contain:
+        ///   blockSize, framesPerRepetition, warmUpFrames, repetitions
+        ///   inputs: [ { handle, frames } ] - stimulus which is re-applied before every block
+        ///   outputEvents: [ handle ] - event endpoints which are read after every block, as a host would
+        choc::value::Value benchmarkRenderPerformance (choc::javascript::ArgumentList args)
+        {
+            auto options = args[1];
+
+            if (options == nullptr || ! options->isObject())
+                return createErrorObject ("Expected an options object");
+
+            auto getOption = [&] (const char* name, uint32_t defaultValue)
+            {
+                return options->hasObjectMember (name) ? (*options)[name].getWithDefault<uint32_t> (defaultValue)
+                                                       : defaultValue;
+            };
+
+            auto blockSize   = std::max (1u, getOption ("blockSize", 512));
+            auto frames      = std::max (blockSize, getOption ("framesPerRepetition", 65536));
+            auto warmUp      = getOption ("warmUpFrames", frames);
+            auto repetitions = std::max (1u, getOption ("repetitions", 10));
+
+            struct Stimulus
+            {
+                EndpointHandle handle;
+                std::vector<char> frameData;
+                uint32_t numFrames;
+            };
+
+            std::vector<Stimulus> stimuli;
+
+            if (options->hasObjectMember ("inputs"))
+            {
+                for (auto input : (*options)["inputs"])
+                {
+                    auto handle = input["handle"].getWithDefault<EndpointHandle> (0);
+                    auto data = input["frames"];
+
+                    auto coercedData = endpointTypeCoercionHelpers.coerceArray (handle, data, cmaj::EndpointType::stream);
+
+                    if (! coercedData)
+                        return createErrorObject ("Cannot convert benchmark input to target type");
+
+                    // take a copy, as the coercion scratch space gets reused for the next input
+                    auto source = static_cast<const char*> (coercedData.data);
+                    stimuli.push_back ({ handle, std::vector<char> (source, source + coercedData.size), data.getType().getNumElements() });
+                }
+            }
+
+            std::vector<EndpointHandle> outputEventHandles;
+
+            if (options->hasObjectMember ("outputEvents"))
+                for (auto handle : (*options)["outputEvents"])
+                    outputEventHandles.push_back (handle.getWithDefault<EndpointHandle> (0));
+
+            uint64_t numEventsRead = 0;
+
+            try
+            {
+                setBlockSize (blockSize);
+
+                auto renderBlock = [&]
+                {
+                    for (auto& s : stimuli)
+                        performer.setInputFrames (s.handle, s.frameData.data(), std::min (s.numFrames, blockSize));
+
+                    performer.advance();
+
+                    for (auto handle : outputEventHandles)
+                    {
+                        performer.iterateOutputEvents (handle, [&] (EndpointHandle, uint32_t, uint32_t, const void*, uint32_t)
+                        {
+                            ++numEventsRead;
+                            return true;
+                        });
+                    }
+                };
+
+                auto blockCount = frames / blockSize;
+                auto framesRendered = static_cast<double> (blockCount * blockSize);
+
+                for (uint32_t i = 0; i < warmUp / blockSize; ++i)
+                    renderBlock();
+
+                InstructionCounter instructionCounter;
+                std::vector<double> nanosecondsPerFrame, instructionsPerFrame;
+                nanosecondsPerFrame.reserve (repetitions);
+                instructionsPerFrame.reserve (repetitions);
+                numEventsRead = 0;
+
+                // only the render calls are counted, so that the bookkeeping here can't look like a render allocation
+                std::optional<size_t> numAllocations;
+
+                for (uint32_t rep = 0; rep < repetitions; ++rep)
+                {
+                    instructionCounter.start();
+                    auto startTime = std::chrono::steady_clock::now();
+                    auto allocationsBefore = cmaj::getAllocationCount();
+
+                    for (uint32_t i = 0; i < blockCount; ++i)
+                        renderBlock();
+
+                    auto allocationsAfter = cmaj::getAllocationCount();
+                    auto endTime = std::chrono::steady_clock::now();
+                    auto instructions = instructionCounter.stop();
+
+                    if (allocationsBefore && allocationsAfter)
+                        numAllocations = numAllocations.value_or (0) + (*allocationsAfter - *allocationsBefore);
+
+                    std::chrono::duration<double, std::nano> elapsed = endTime - startTime;
+                    nanosecondsPerFrame.push_back (elapsed.count() / framesRendered);
+
+                    if (instructions)
+                        instructionsPerFrame.push_back (static_cast<double> (*instructions) / framesRendered);
+                }
+
+                auto result = choc::value::createObject ("BenchmarkResult",
+                                                         "blockSize", static_cast<int32_t> (blockSize),
+                                                         "framesPerRepetition", static_cast<int32_t> (blockCount * blockSize),
+                                                         "repetitions", static_cast<int32_t> (repetitions),
+                                                         "nsPerFrame", createBenchmarkStatistics (std::move (nanosecondsPerFrame)));
+
+                if (instructionsPerFrame.size() == repetitions)
+                    result.addMember ("instructionsPerFrame", createBenchmarkStatistics (std::move (instructionsPerFrame)));
+
+                auto totalBlocks = static_cast<double> (blockCount * repetitions);
+
+                if (! outputEventHandles.empty())
+                    result.addMember ("eventsPerBlock", static_cast<double> (numEventsRead) / totalBlocks);
+
+                if (numAllocations)
+                    result.addMember ("allocationsPerBlock", static_cast<double> (*numAllocations) / totalBlocks);
+
+                return result;
+            }
+            catch (const std::exception& e)
+            {
+                return createErrorObject (e.what());
+            }
+        }
+
         static cmaj::EndpointHandle getEndpointHandle (choc::javascript::ArgumentList args, size_t index)
         {
             if (auto data = args[index])
@@ -487,6 +633,9 @@ private:
             engine.link (messages);
             auto endTime = std::chrono::steady_clock::now();
 
+            if (auto timings = PassTimings::fromJSONString (engine.getLastPassTimings()))
+                owner.passTimings.merge (*timings);
+
             if (! messages.empty())
                 return messages.toJSON();
 
@@ -504,6 +653,11 @@ private:
             return choc::value::Value (engine.isLinked());
         }
 
+        choc::value::Value getLastBuildLog()
+        {
+            return choc::value::Value (engine.getLastBuildLog());
+        }
+
         choc::value::Value createPerformer()
         {
             if (! engine.isLinked())
@@ -575,6 +729,10 @@ private:
     std::string engineTypeName, actualEngineName;
     cmaj::BuildSettings buildSettings;
 
+    /// If the timePasses build setting is enabled, this accumulates the
+    /// timings from every engine that gets linked
+    PassTimings passTimings;
+
     ObjectHandleList<Performer, std::unique_ptr<Performer>> performers;
     ObjectHandleList<Engine, std::unique_ptr<Engine>> engines;
     ObjectHandleList<cmaj::Program, std::unique_ptr<cmaj::Program>> programs;
@@ -800,6 +958,14 @@ private:
         return createErrorObject ("Cannot find engine");
     }
 
+    choc::value::Value engineGetLastBuildLog (choc::javascript::ArgumentList args)
+    {
+        if (auto engine = getEngine (args))
+            return engine->getLastBuildLog();
+
+        return createErrorObject ("Cannot find engine");
+    }
+
     choc::value::Value engineCreatePerformer (choc::javascript::ArgumentList args)
     {
         if (auto engine = getEngine (args))
@@ -919,6 +1085,14 @@ private:
         return createErrorObject ("Cannot find performer");
     }
 
+    choc::value::Value performerBenchmarkRenderPerformance (choc::javascript::ArgumentList args)
+    {
+        if (auto performer = getPerformer (args))
+            return performer->benchmarkRenderPerformance (args);
+
+        return createErrorObject ("Cannot find performer");
+    }
+
     //==============================================================================
     static std::string getWrapperScript()
     {
@@ -1010,6 +1184,7 @@ class Engine
     link()                              { return _engineLink (this.id); }
     isLoaded()                          { return _engineIsLoaded (this.id); }
     isLinked()                          { return _engineIsLinked (this.id); }
+    getLastBuildLog()                   { return _engineGetLastBuildLog (this.id); }
     createPerformer()                   { var result = _engineCreatePerformer (this.id); return isError (result) ? result : new Performer (result); }
     getEndpointHandle (id)              { return _engineGetEndpointHandle (this.id, id); }
     getAvailableCodeGenTargetTypes()    { return _engineGetAvailableCodeGenTargetTypes (this.id); }
@@ -1032,6 +1207,7 @@ class Performer
     addInputEvent (h, d)                { return _performerAddInputEvent (this.id, h, d); }
     getXRuns()                          { return _performerGetXRuns (this.id); }
     calculateRenderPerformance (bs, f)  { return _performerCalculateRenderPerformance (this.id, bs, f); }
+    benchmarkRenderPerformance (o)      { return _performerBenchmarkRenderPerformance (this.id, o); }
 }
 
 class Program
@@ -0,0 +1,138 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <vector>
+
+#include "choc/platform/choc_Platform.h"
+#include "choc/containers/choc_Value.h"
+
+#if CHOC_LINUX
+ #include <cstring>
+ #include <unistd.h>
+ #include <sys/ioctl.h>
+ #include <sys/syscall.h>
+ #include <linux/perf_event.h>
+#endif
+
+namespace cmaj::javascript
+{
+
+//==============================================================================
+/// Counts the user-space instructions retired by the calling thread, where the
+/// platform makes this possible (currently only linux, via perf_event_open).
+/// On other platforms, or if the kernel refuses access, isAvailable() is false.
+struct InstructionCounter
+{
+    InstructionCounter()
+    {
+       #if CHOC_LINUX
+        perf_event_attr attr;
+        std::memset (std::addressof (attr), 0, sizeof (attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof (attr);
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        fd = static_cast<int> (syscall (__NR_perf_event_open, std::addressof (attr), 0, -1, -1, 0));
+       #endif
+    }
+
+    ~InstructionCounter()
+    {
+       #if CHOC_LINUX
+        if (fd >= 0)
+            close (fd);
+       #endif
+    }
+
+    InstructionCounter (const InstructionCounter&) = delete;
+    InstructionCounter& operator= (const InstructionCounter&) = delete;
+
+    bool isAvailable() const        { return fd >= 0; }
+
+    void start()
+    {
+       #if CHOC_LINUX
+        if (fd >= 0)
+        {
+            ioctl (fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl (fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+       #endif
+    }
+
+    std::optional<uint64_t> stop()
+    {
+       #if CHOC_LINUX
+        if (fd >= 0)
+        {
+            ioctl (fd, PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t count = 0;
+
+            if (read (fd, std::addressof (count), sizeof (count)) == static_cast<ssize_t> (sizeof (count)))
+                return count;
+        }
+       #endif
+
+        return {};
+    }
+
+private:
+    int fd = -1;
+};
+
+//==============================================================================
+/// Summarises a set of per-repetition measurements as a choc object containing
+/// min, median, p95, mean and max values.
+inline choc::value::Value createBenchmarkStatistics (std::vector<double> samples)
+{
+    if (samples.empty())
+        return {};
+
+    std::sort (samples.begin(), samples.end());
+
+    auto getPercentile = [&] (double percentile)
+    {
+        auto index = static_cast<size_t> (std::ceil (percentile * static_cast<double> (samples.size())));
+        return samples[std::min (samples.size() - 1, index > 0 ? index - 1 : 0)];
+    };
+
+    double total = 0;
+
+    for (auto s : samples)
+        total += s;
+
+    auto median = (samples.size() & 1) != 0 ? samples[samples.size() / 2]
+                                            : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) * 0.5;
+
+    return choc::value::createObject ("BenchmarkStatistics",
+                                      "min",    choc::value::createFloat64 (samples.front()),
+                                      "median", choc::value::createFloat64 (median),
+                                      "p95",    choc::value::createFloat64 (getPercentile (0.95)),
+                                      "mean",   choc::value::createFloat64 (total / static_cast<double> (samples.size())),
+                                      "max",    choc::value::createFloat64 (samples.back()));
+}
+
+} // namespace cmaj::javascript
@@ -507,6 +507,57 @@ function testCompile (testLink, options)
     testSection.reportSuccess();
 }
 
+//==============================================================================
+/**
+    This test compiles and links the code, and then checks that each of the expected
+    strings matches a whole line of the engine's build log. The log is plain text,
+    and leading and trailing whitespace on each line is ignored.
+
+    e.g.
+    ## testBuildLog ("Event delay queue for Test._delay1: 16 events, 128 bytes")
+    ## testBuildLog (["first line", "second line"], { optimiseStateLayout: true })
+*/
+function testBuildLog (expectedText, options)
+{
+    let testSection = getCurrentTestSection();
+    let engine = buildEngineWithLoadedProgram (testSection, options, {});
+
+    if (isError (engine, options))
+    {
+        testSection.reportFail (engine);
+        return;
+    }
+
+    let error = engine.link();
+
+    if (isError (error, options))
+    {
+        testSection.reportFail (error);
+        return;
+    }
+
+    let log = engine.getLastBuildLog();
+    let lines = log.split ("\n");
+
+    for (let i = 0; i < lines.length; ++i)
+        lines[i] = lines[i].trim();
+
+    if (! Array.isArray (expectedText))
+        expectedText = [expectedText];
+
+    for (let i = 0; i < expectedText.length; ++i)
+    {
+        if (! lines.includes (expectedText[i]))
+        {
+            testSection.logMessage ("Build log:\n" + log);
+            testSection.reportFail ("Expected the build log to contain the line '" + expectedText[i] + "'");
+            return;
+        }
+    }
+
+    testSection.reportSuccess();
+}
+
 //==============================================================================
 /* This test checks whether the console output matches what was expected
 
@@ -618,6 +669,24 @@ function testConsole (expectedConsoleMsg, options)
     e.g.
     ## performanceTest ({ frequency:44100, minBlockSize:4, maxBlockSize: 1024, samplesToRender:100000 })
     ## performanceTest ({ frequency:44100, minBlockSize:4, maxBlockSize: 1024, samplesToRender:100000, patch: "testPatch.cmajorpatch" })
+
+    If a `repetitions` property is supplied, the test runs in benchmark mode: each block size is
+    warmed up and then rendered the given number of times, and the min/median/p95 cost per frame
+    (in nanoseconds, and in instructions where the platform can count them) is reported.
+    Any output events are read after each block, as a host would, and if the allocation
+    checker is enabled, the test fails if rendering allocates any memory.
+    Other benchmark options are:
+
+      warmUpFrames          - frames rendered before measuring (defaults to samplesToRender)
+      stimulus              - the input signal: "ramp" (default), "noise", "sine" or "silence"
+      resultsFile           - a .json file to which the results are written
+      baselineFile          - a .json file of earlier results to compare against. If it doesn't
+                              exist, it will be created from the current results
+      maxRegressionPercent  - how much slower than the baseline median a block size may be
+                              before the test fails (defaults to 10)
+
+    e.g.
+    ## performanceTest ({ frequency:44100, minBlockSize:32, maxBlockSize: 512, samplesToRender:65536, repetitions:20, baselineFile: "baseline.json" })
 */
 
 function performanceTest (options)
@@ -680,6 +749,13 @@ function performanceTest (options)
     testSection.logMessage ("Total     : " + Math.round (totalTime * 1000) + " ms");
 
     let performer = engine.createPerformer();
+
+    if (options.repetitions !== undefined)
+    {
+        runPerformanceBenchmark (testSection, options, performer, inputEndpoints, outputEndpoints);
+        return;
+    }
+
     let blockSize = options.minBlockSize;
     let inputFrames = [];
 
@@ -709,6 +785,227 @@ function performanceTest (options)
     testSection.reportSuccess();
 }
 
+function createBenchmarkStimulus (type, numFrames)
+{
+    let frames = [];
+    let seed = 12345;
+
+    for (let i = 0; i < numFrames; i++)
+    {
+        if (type == "silence")      frames[i] = 0;
+        else if (type == "sine")    frames[i] = Math.sin (i * 0.0628);
+        else if (type == "noise")   { seed = (seed * 1103515245 + 12345) % 2147483648; frames[i] = seed / 1073741824 - 1.0; }
+        else                        frames[i] = i / numFrames;
+    }
+
+    return frames;
+}
+
+function runPerformanceBenchmark (testSection, options, performer, inputEndpoints, outputEndpoints)
+{
+    let stimulus = createBenchmarkStimulus (options.stimulus, options.maxBlockSize);
+    let maxRegressionPercent = options.maxRegressionPercent !== undefined ? options.maxRegressionPercent : 10;
+    let results = { engine: getEngineName(), frequency: options.frequency, blockSizes: [] };
+    let inputs = [];
+
+    for (let i = 0; i < inputEndpoints.length; i++)
+        if (inputEndpoints[i].endpointType == "stream")
+            inputs.push ({ handle: inputEndpoints[i].handle, frames: stimulus });
+
+    let outputEvents = [];
+
+    for (let i = 0; i < outputEndpoints.length; i++)
+        if (outputEndpoints[i].endpointType == "event")
+            outputEvents.push (outputEndpoints[i].handle);
+
+    for (let blockSize = options.minBlockSize; blockSize <= options.maxBlockSize; blockSize *= 2)
+    {
+        let result = performer.benchmarkRenderPerformance ({ blockSize: blockSize,
+                                                             framesPerRepetition: options.samplesToRender,
+                                                             warmUpFrames: options.warmUpFrames !== undefined ? options.warmUpFrames : options.samplesToRender,
+                                                             repetitions: options.repetitions,
+                                                             inputs: inputs,
+                                                             outputEvents: outputEvents });
+
+        if (isError (result))
+        {
+            testSection.reportFail (result);
+            return;
+        }
+
+        let nsPerFrame = result.nsPerFrame;
+        let utilisation = 100.0 * options.frequency * nsPerFrame.median * 1.0e-9;
+        let message = "Block size " + blockSize + ", ns/frame min " + nsPerFrame.min.toFixed (2)
+                        + " median " + nsPerFrame.median.toFixed (2) + " p95 " + nsPerFrame.p95.toFixed (2);
+
+        if (result.instructionsPerFrame !== undefined)
+            message += ", instructions/frame median " + result.instructionsPerFrame.median.toFixed (1);
+
+        if (result.eventsPerBlock !== undefined)
+            message += ", events/block " + result.eventsPerBlock.toFixed (1);
+
+        if (result.allocationsPerBlock !== undefined)
+            message += ", allocations/block " + result.allocationsPerBlock.toFixed (2);
+
+        testSection.logMessage (message + ", utilisation = " + utilisation.toFixed (2));
+        results.blockSizes.push (result);
+
+        if (result.allocationsPerBlock !== undefined && result.allocationsPerBlock > 0)
+        {
+            testSection.reportFail ("Rendering allocated memory");
+            return;
+        }
+    }
+
+    if (options.resultsFile !== undefined)
+        testSection.writeEventData (options.resultsFile, results);
+
+    if (options.baselineFile !== undefined)
+    {
+        let baseline = testSection.readEventData (options.baselineFile);
+
+        if (baseline === undefined || isError (baseline))
+        {
+            testSection.logMessage ("Can't find baseline file " + options.baselineFile + " - write it");
+            testSection.writeEventData (options.baselineFile, results);
+        }
+        else
+        {
+            let regressions = 0;
+
+            for (let i = 0; i < results.blockSizes.length; i++)
+            {
+                let current = results.blockSizes[i];
+
+                for (let j = 0; j < baseline.blockSizes.length; j++)
+                {
+                    let previous = baseline.blockSizes[j];
+
+                    if (previous.blockSize != current.blockSize)
+                        continue;
+
+                    let changePercent = 100.0 * (current.nsPerFrame.median - previous.nsPerFrame.median) / previous.nsPerFrame.median;
+
+                    if (changePercent > maxRegressionPercent)
+                    {
+                        testSection.logMessage ("Block size " + current.blockSize + " is " + changePercent.toFixed (1)
+                                                  + "% slower than the baseline median of " + previous.nsPerFrame.median.toFixed (2) + " ns/frame");
+                        ++regressions;
+                    }
+                }
+            }
+
+            if (regressions != 0)
+            {
+                testSection.reportFail ("performance regression");
+                return;
+            }
+        }
+    }
+
+    testSection.reportSuccess();
+}
+
+//==============================================================================
+/*
+    This test checks that the time taken to compile a graph grows roughly linearly
+    with its size. For each of the given sizes, it generates a main graph made of that
+    many columns of `width` nodes, where every node in a column is connected to every
+    node in the previous one, so the number of paths through the graph grows
+    exponentially with its size. Each node is an instance of a processor called Stage,
+    which the test's source must declare, with a stream input `in` and output `out`.
+
+    The test fails if the time for the largest graph, divided by its size, is more
+    than maxRatio (defaulting to 4) times the same figure for the smallest one.
+
+    e.g.
+    ## compileScalingTest ({ sizes: [25, 50, 100, 200], width: 4 })
+*/
+function compileScalingTest (options)
+{
+    let testSection = getCurrentTestSection();
+    let width = options.width !== undefined ? options.width : 4;
+    let maxRatio = options.maxRatio !== undefined ? options.maxRatio : 4;
+    let timesPerColumn = [];
+
+    for (let size of options.sizes)
+    {
+        let engine = createEngine (options);
+        updateBuildSettings (engine, options.frequency, options.blockSize, false, options);
+
+        let program = new Program();
+        let parseResult = program.parse (testSection.source + createScalingTestGraph (size, width) + testSection.globalSource);
+
+        if (isError (parseResult))
+        {
+            testSection.reportFail (parseResult);
+            return;
+        }
+
+        let loadTime = engine.load (program);
+
+        if (isError (loadTime))
+        {
+            testSection.reportFail (loadTime);
+            return;
+        }
+
+        let linkTime = engine.link();
+
+        if (isError (linkTime))
+        {
+            testSection.reportFail (linkTime);
+            return;
+        }
+
+        let totalTime = loadTime + linkTime;
+        timesPerColumn.push (totalTime / size);
+
+        testSection.logMessage ("Columns: " + size + ", nodes: " + (size * width) + ", load + link time: "
+                                  + Math.round (totalTime * 1000) + " ms");
+    }
+
+    let ratio = timesPerColumn[timesPerColumn.length - 1] / timesPerColumn[0];
+    testSection.logMessage ("Time per column, largest vs smallest graph: " + ratio.toFixed (2));
+
+    if (ratio > maxRatio)
+    {
+        testSection.reportFail ("Compile time grows faster than the size of the graph");
+        return;
+    }
+
+    testSection.reportSuccess();
+}
+
+function createScalingTestGraph (numColumns, width)
+{
+    let nodes = "", connections = "";
+    let nodeName = (column, row) => "n" + column + "_" + row;
+
+    for (let column = 0; column < numColumns; column++)
+    {
+        for (let row = 0; row < width; row++)
+        {
+            nodes += "    node " + nodeName (column, row) + " = Stage;\n";
+
+            if (column == 0)
+                connections += "        in -> " + nodeName (column, row) + ".in;\n";
+            else
+                for (let source = 0; source < width; source++)
+                    connections += "        " + nodeName (column - 1, source) + ".out -> " + nodeName (column, row) + ".in;\n";
+
+            if (column == numColumns - 1)
+                connections += "        " + nodeName (column, row) + ".out -> out;\n";
+        }
+    }
+
+    return "\ngraph Generated [[ main ]]\n{\n"
+            + "    input stream float in;\n"
+            + "    output stream float out;\n\n"
+            + nodes
+            + "\n    connection\n    {\n" + connections + "    }\n}\n";
+}
+
 //==============================================================================
 /*
     This test takes the filename of a .cmajorpatch and tries to build it, failing
@@ -1240,6 +1537,9 @@ function updateBuildSettings (engine, defaultFrequency, defaultBlockSize, ignore
         if (options.sessionID !== undefined)          buildSettings.sessionID = options.sessionID;
         if (options.optimisationLevel !== undefined)  buildSettings.optimisationLevel = options.optimisationLevel;
         if (options.mainProcessor !== undefined)      buildSettings.mainProcessor = options.mainProcessor;
+        if (options.optimiseStateLayout !== undefined) buildSettings.optimiseStateLayout = options.optimiseStateLayout;
+        if (options.packNodeArrays !== undefined)      buildSettings.packNodeArrays = options.packNodeArrays;
+        if (options.approximateMaths !== undefined)    buildSettings.approximateMaths = options.approximateMaths;
     }
 
     engine.setBuildSettings (buildSettings);
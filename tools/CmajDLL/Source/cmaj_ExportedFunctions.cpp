@@ -26,7 +26,7 @@
 #endif
 
 
-CMAJ_API_EXPORT cmaj::Library::EntryPoints* cmajor_getEntryPointsV10()
+CMAJ_API_EXPORT cmaj::Library::EntryPoints* cmajor_getEntryPointsV11()
 {
     struct EntryPointsImpl  : public cmaj::Library::EntryPoints
     {
@@ -41,7 +41,8 @@ static void addSourceToProgram (cmaj::AST::Program& program, const std::set<std:
 
         auto errors = std::string (choc::com::StringPtr (program.parse (sourceFile.string().c_str(),
                                                                         sourceContent.data(),
-                                                                        sourceContent.length())));
+                                                                        sourceContent.length(),
+                                                                        nullptr)));
 
         if (! errors.empty())
             throw std::runtime_error (errors);
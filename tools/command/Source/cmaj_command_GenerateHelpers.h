@@ -19,6 +19,7 @@
 #pragma once
 
 #include <algorithm>
+#include "../../../include/cmajor/helpers/cmaj_PassTimings.h"
 #include "choc/text/choc_TextTable.h"
 #include "choc/text/choc_CodePrinter.h"
 #include "choc/text/choc_Wildcard.h"
@@ -158,6 +159,9 @@ static inline cmaj::Engine::CodeGenOutput generateCodeAndCheckResult (cmaj::Patc
     if (result.messages.hasWarnings())
         std::cerr << result.messages.toString();
 
+    if (auto timings = cmaj::PassTimings::fromJSONString (result.passTimings))
+        std::cerr << timings->toTable();
+
     return result;
 }
 
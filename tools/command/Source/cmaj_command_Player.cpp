@@ -18,6 +18,7 @@
 
 #include <iomanip>
 #include "../../../modules/playback/include/cmaj_PatchWindow.h"
+#include "../../../modules/playback/include/cmaj_AudioSources.h"
 #include "../../../modules/scripting/include/cmaj_ScriptEngine.h"
 #include "../../../modules/server/include/cmaj_PatchPlayerServer.h"
 #include "choc/containers/choc_ArgumentList.h"
@@ -32,7 +33,48 @@ static std::unique_ptr<cmaj::audio_utils::AudioMIDIPlayer> createDefaultAudioDev
 
 
 //==============================================================================
-static void runPatch (cmaj::PatchPlayer& player, const std::string& filename, int64_t framesToRender, bool stopOnError)
+static void printNodeProfile (const choc::value::ValueView& cpuInfo)
+{
+    auto percent = [] (const choc::value::ValueView& level)
+    {
+        return std::to_string (static_cast<int> (100.0f * level.getWithDefault<float> (0) + 0.5f)) + "%";
+    };
+
+    std::cout << "CPU: " << percent (cpuInfo["level"]);
+
+    if (cpuInfo.hasObjectMember ("nodes"))
+    {
+        uint32_t numShown = 0;
+
+        for (auto node : cpuInfo["nodes"])
+        {
+            if (++numShown > 5)
+                break;
+
+            std::cout << (numShown == 1 ? "  " : ", ") << node["name"].getWithDefault<std::string> ({}) << ": " << percent (node["level"]);
+        }
+    }
+
+    std::cout << std::endl;
+}
+
+// Gives each of the patch's audio inputs its own looping stream of the given file
+static void attachInputFile (cmaj::PatchPlayer& player, const std::string& inputFile)
+{
+    for (auto& e : player.patch.getInputEndpoints())
+    {
+        if (e.isStream() && e.getNumAudioChannels() != 0)
+        {
+            if (auto source = cmaj::audio_utils::StreamingFilePlayerSource::createFromFile (inputFile))
+                player.patch.setCustomAudioSourceForInput (e.endpointID, source);
+            else
+                std::cerr << "Failed to read from audio input" << std::endl;
+        }
+    }
+}
+
+static void runPatch (cmaj::PatchPlayer& player, const std::string& filename, int64_t framesToRender,
+                      bool stopOnError, uint32_t nodeProfileFrames, const std::string& inputFile)
 {
     choc::messageloop::Timer checkTimer;
     std::atomic<bool> shouldStop { false };
@@ -59,6 +101,23 @@ static void runPatch (cmaj::PatchPlayer& player, const std::string& filename, in
             shouldStop = true;
     };
 
+    if (nodeProfileFrames != 0)
+    {
+        player.patch.handleCPUInfo = printNodeProfile;
+        player.patch.setCPUInfoMonitorChunkSize (nodeProfileFrames);
+    }
+
+    if (! inputFile.empty())
+    {
+        player.onPatchLoaded = [&player, inputFile, previousCallback = player.onPatchLoaded]
+        {
+            if (previousCallback)
+                previousCallback();
+
+            attachInputFile (player, inputFile);
+        };
+    }
+
     if (! player.loadPatch (filename))
         throw std::runtime_error ("Failed to load this patch");
 
@@ -88,6 +147,11 @@ void playFile (choc::ArgumentList& args,
             throw std::runtime_error ("Illegal length");
     }
 
+    std::string inputFile;
+
+    if (auto input = args.removeExistingFileIfPresent ("--input"))
+        inputFile = input->string();
+
     auto files = args.getAllAsExistingFiles();
 
     if (files.size() != 1)
@@ -127,6 +191,9 @@ void playFile (choc::ArgumentList& args,
         return;
     }
 
+    // When node profiling is enabled, print the levels roughly every couple of seconds
+    auto nodeProfileFrames = buildSettings.shouldProfileNodes() ? 2 * (audioOptions.sampleRate == 0 ? 44100 : audioOptions.sampleRate) : 0;
+
     auto audioPlayer = createDefaultAudioDevice (audioOptions);
 
     if (noGUI)
@@ -134,14 +201,14 @@ void playFile (choc::ArgumentList& args,
         cmaj::PatchPlayer player (engineOptions, buildSettings, true);
         player.setAudioMIDIPlayer (std::move (audioPlayer));
         player.startPlayback();
-        runPatch (player, file.string(), framesToRender, stopOnError);
+        runPatch (player, file.string(), framesToRender, stopOnError, nodeProfileFrames, inputFile);
     }
     else
     {
         choc::ui::setWindowsDPIAwareness();
         cmaj::PatchWindow patchWindow (engineOptions, buildSettings);
         patchWindow.player.setAudioMIDIPlayer (std::move (audioPlayer));
-        runPatch (patchWindow.player, file.string(), framesToRender, stopOnError);
+        runPatch (patchWindow.player, file.string(), framesToRender, stopOnError, nodeProfileFrames, inputFile);
     }
 }
 
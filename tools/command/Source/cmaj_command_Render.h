@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <condition_variable>
 #include "choc/audio/choc_MIDIFile.h"
 #include "choc/gui/choc_WebView.h"
 #include "../../../modules/playback/include/cmaj_PatchPlayer.h"
@@ -74,6 +75,129 @@ struct RenderOptions
 };
 
 
+//==============================================================================
+/// A bounded FIFO of audio frames, used to pass audio between the render thread and
+/// the threads that read and write the audio files, so that the file I/O overlaps with
+/// the rendering. Either side will wait while the other one catches up.
+struct AudioFrameQueue
+{
+    AudioFrameQueue (uint32_t numChannels, uint32_t numFrames) : buffer (numChannels, numFrames) {}
+
+    uint32_t getNumChannels() const     { return buffer.getNumChannels(); }
+
+    /// Waits for space, and adds all the frames. Returns false if the queue was closed first.
+    bool write (choc::buffer::ChannelArrayView<const float> source)
+    {
+        auto size = buffer.getNumFrames();
+
+        while (source.getNumFrames() != 0)
+        {
+            uint64_t writePos;
+
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+                condition.wait (lock, [&] { return closed || numWritten - numRead < size; });
+
+                if (closed)
+                    return false;
+
+                writePos = numWritten;
+            }
+
+            // Only this thread can reduce the free space, so it's safe to copy without the lock
+            auto numFree = static_cast<uint32_t> (size - (writePos - getNumRead()));
+            auto start = static_cast<uint32_t> (writePos % size);
+            auto numToCopy = std::min ({ numFree, size - start, source.getNumFrames() });
+
+            choc::buffer::copy (buffer.getFrameRange ({ start, start + numToCopy }), source.getStart (numToCopy));
+            source = source.fromFrame (numToCopy);
+
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                numWritten += numToCopy;
+            }
+
+            condition.notify_all();
+        }
+
+        return true;
+    }
+
+    /// Waits until some frames are available, and copies as many as will fit into the
+    /// destination. Returns the number copied, which is 0 once the queue has been closed
+    /// and all its frames have been read.
+    uint32_t read (choc::buffer::ChannelArrayView<float> dest)
+    {
+        auto size = buffer.getNumFrames();
+        uint64_t readPos, numAvailable;
+
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            condition.wait (lock, [&] { return closed || numWritten != numRead; });
+
+            readPos = numRead;
+            numAvailable = numWritten - numRead;
+        }
+
+        auto start = static_cast<uint32_t> (readPos % size);
+        auto numToCopy = static_cast<uint32_t> (std::min<uint64_t> ({ numAvailable, size - start, dest.getNumFrames() }));
+
+        if (numToCopy != 0)
+        {
+            choc::buffer::copy (dest.getStart (numToCopy), buffer.getFrameRange ({ start, start + numToCopy }));
+
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                numRead += numToCopy;
+            }
+
+            condition.notify_all();
+        }
+
+        return numToCopy;
+    }
+
+    /// Fills the whole of the destination, returning false if the queue runs out first.
+    bool readAll (choc::buffer::ChannelArrayView<float> dest)
+    {
+        for (uint32_t numDone = 0; numDone < dest.getNumFrames();)
+        {
+            auto num = read (dest.fromFrame (numDone));
+
+            if (num == 0)
+                return false;
+
+            numDone += num;
+        }
+
+        return true;
+    }
+
+    /// Marks the end of the stream, or tells the writer that the reader has given up.
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            closed = true;
+        }
+
+        condition.notify_all();
+    }
+
+private:
+    choc::buffer::ChannelArrayBuffer<float> buffer;
+    std::mutex mutex;
+    std::condition_variable condition;
+    uint64_t numWritten = 0, numRead = 0;
+    bool closed = false;
+
+    uint64_t getNumRead()
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        return numRead;
+    }
+};
+
 //==============================================================================
 struct RenderState
 {
@@ -164,26 +288,55 @@ struct RenderState
         if (! patchPlayer.loadPatch (options.patchFile, true))
             throw std::runtime_error ("Could not load patch");
 
-        stopped = false;
+        auto queueSize = std::max (4 * ioChunkSize, 2 * audioOptions.blockSize);
+
+        if (reader != nullptr)
+        {
+            // The render thread reads whole blocks, so the last one may run past the end
+            auto blockSize = audioOptions.blockSize;
+            auto framesToRead = ((framesToRender + blockSize - 1) / blockSize) * blockSize;
+
+            inputQueue = std::make_unique<AudioFrameQueue> (audioOptions.inputChannelCount, queueSize);
+            inputThread = std::thread ([this, framesToRead] { readInputFile (framesToRead); });
+        }
+
+        outputQueue = std::make_unique<AudioFrameQueue> (audioOptions.outputChannelCount, queueSize);
+        outputThread = std::thread ([this] { writeOutputFile(); });
+
+        startTime = std::chrono::steady_clock::now();
         patchPlayer.startPlayback();
     }
 
+    ~RenderState()
+    {
+        if (inputQueue != nullptr)
+            inputQueue->close();
+
+        outputQueue->close();
+
+        if (inputThread.joinable())
+            inputThread.join();
+
+        if (outputThread.joinable())
+            outputThread.join();
+    }
+
     bool provideInput (choc::buffer::ChannelArrayView<float> audioInput,
                        std::vector<choc::midi::ShortMessage>& midiMessages,
                        std::vector<uint32_t>& midiMessageTimes)
     {
         if (framesRendered >= framesToRender)
         {
-            stopped = true;
+            outputQueue->close();
             return false;
         }
 
-        if (reader != nullptr)
+        if (inputQueue != nullptr)
         {
-            if (! reader->readFrames (framesRendered, audioInput))
+            if (! inputQueue->readAll (audioInput))
             {
                 std::cerr << "Failed to read from audio input" << std::endl;
-                stopped = true;
+                outputQueue->close();
                 return false;
             }
         }
@@ -211,34 +364,92 @@ struct RenderState
         if (framesRendered + numFrames > framesToRender)
             return handleOutput (audioOutput.getStart (static_cast<choc::buffer::FrameCount> (framesToRender - framesRendered)));
 
-        if (! writer->appendFrames (audioOutput))
-        {
-            std::cerr << "Failed to write to audio output" << std::endl;
-            stopped = true;
+        if (! outputQueue->write (audioOutput))
             return false;
-        }
 
         framesRendered += audioOutput.getNumFrames();
         return true;
     }
 
+    /// Waits for the output file to be completely written, and prints the throughput
     void waitTillComplete()
     {
-        while (! stopped)
-            std::this_thread::sleep_for (std::chrono::milliseconds (10));
+        outputThread.join();
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+        auto seconds = std::max (elapsed.count(), 1.0e-6);
+
+        std::cout << "Rendered " << framesWritten << " frames in "
+                  << choc::text::getDurationDescription (elapsed) << " ("
+                  << static_cast<uint64_t> (static_cast<double> (framesWritten) / seconds) << " frames per second, "
+                  << choc::text::getDurationDescription (std::chrono::duration<double> (static_cast<double> (framesWritten) / sampleRate))
+                  << " of audio)" << std::endl;
     }
 
-    std::atomic<bool> stopped { true };
-    uint64_t framesToRender = 0, framesRendered = 0;
-    double sampleRate = 0;
+    // Runs on its own thread, decoding the input file ahead of the render thread
+    void readInputFile (uint64_t framesToRead)
+    {
+        choc::buffer::ChannelArrayBuffer<float> chunk (reader->getProperties().numChannels, ioChunkSize);
 
-    cmaj::PatchPlayer patchPlayer;
+        for (uint64_t frame = 0; frame < framesToRead;)
+        {
+            auto numFrames = static_cast<uint32_t> (std::min<uint64_t> (ioChunkSize, framesToRead - frame));
+            auto frames = chunk.getStart (numFrames);
+
+            if (! reader->readFrames (frame, frames))
+                break;
+
+            if (! inputQueue->write (frames))
+                break;
+
+            frame += numFrames;
+        }
+
+        inputQueue->close();
+    }
+
+    // Runs on its own thread, writing the render thread's output to the file
+    void writeOutputFile()
+    {
+        choc::buffer::ChannelArrayBuffer<float> chunk (outputQueue->getNumChannels(), ioChunkSize);
+
+        while (auto numFrames = outputQueue->read (chunk))
+        {
+            if (! writer->appendFrames (chunk.getStart (numFrames)))
+            {
+                std::cerr << "Failed to write to audio output" << std::endl;
+                outputQueue->close();
+
+                if (inputQueue != nullptr)
+                    inputQueue->close();
+
+                break;
+            }
+
+            framesWritten += numFrames;
+        }
+
+        // Deleting the writer finishes off the file
+        writer.reset();
+    }
+
+    static constexpr uint32_t ioChunkSize = 16384;
+
+    uint64_t framesToRender = 0, framesRendered = 0, framesWritten = 0;
+    double sampleRate = 0;
+    std::chrono::steady_clock::time_point startTime;
 
     std::unique_ptr<choc::audio::AudioFileReader> reader;
     std::unique_ptr<choc::audio::AudioFileWriter> writer;
 
     choc::midi::Sequence inputMIDI;
     choc::midi::Sequence::Iterator inputMIDIIterator { inputMIDI };
+
+    // These are declared before the player, so that they outlive its render thread
+    std::unique_ptr<AudioFrameQueue> inputQueue, outputQueue;
+    std::thread inputThread, outputThread;
+
+    cmaj::PatchPlayer patchPlayer;
 };
 
 
@@ -26,6 +26,8 @@
 #include "unit_tests/cmaj_PatchHelperUnitTests.h"
 #include "unit_tests/cmaj_GraphvizUnitTests.h"
 #include "unit_tests/cmaj_CLAPPluginUnitTests.h"
+#include "unit_tests/cmaj_StringPoolUnitTests.h"
+#include "unit_tests/cmaj_AudioSourceUnitTests.h"
 
 //==============================================================================
 static void runAllTests (choc::test::TestProgress& progress)
@@ -36,6 +38,8 @@ static void runAllTests (choc::test::TestProgress& progress)
     cmaj::patch_helper_tests::runUnitTests (progress);
     cmaj::graphviz_tests::runUnitTests (progress);
     cmaj::plugin::clap::test::runUnitTests (progress);
+    cmaj::string_pool_tests::runUnitTests (progress);
+    cmaj::audio_source_tests::runUnitTests (progress);
     cmaj::runServerUnitTests (progress);
 }
 
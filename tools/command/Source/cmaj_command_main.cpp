@@ -69,6 +69,14 @@ cmaj <command> [options]    Runs the given command. Options can include the foll
     --debug                 Turn on debug output from the performer
     --sessionID=n           Set the session id to the given value
     --eventBufferSize=n     Set the max number of events per buffer
+    --optimise-state-layout Group the small, frequently-used state variables together
+    --pack-node-arrays      Store the state of node arrays as a struct of arrays, so voices can be vectorised
+    --approximate-maths     Use faster approximations of float32 sin, cos, exp, log, pow and tanh, which have a
+                            small bounded error (see std::intrinsics::internal::approximate_math_implementations)
+    --time-passes           Measure the time and memory used by each compiler pass, and print a summary
+                            (supported by the generate and test commands)
+    --profile-nodes         Measure the CPU used by each node of the top-level graph, and print it while
+                            playing (only supported by the llvm engine)
     --engine=<type>         Use the specified engine - e.g. llvm, webview, cpp
     --simd                  WASM generation uses SIMD/non-SIMD at runtime (default)
     --no-simd               WASM generation does not emit SIMD
@@ -93,6 +101,8 @@ cmaj play file [opts]       Plays a .cmajorpatch, or executes a .js javascript f
                             any errors that are found, and exits
     --rate=<rate>           Use the specified sample rate
     --block-size=<size>     Request the given block size
+    --input=<file>          Loop the given audio file into the patch's audio inputs. The file is
+                            streamed from disk, so it can be any length
 
 cmaj server [opts] dir      Run cmaj as an http service, serving the patches within the given
                             directory. Connect to the server using a browser to the http address
@@ -168,6 +178,21 @@ static cmaj::BuildSettings parseBuildArgs (choc::ArgumentList& args)
     if (auto bufferSize = args.removeIntValue<uint32_t> ("--eventBufferSize"))
         buildSettings.setEventBufferSize (*bufferSize);
 
+    if (args.removeIfFound ("--optimise-state-layout"))
+        buildSettings.setOptimiseStateLayout (true);
+
+    if (args.removeIfFound ("--pack-node-arrays"))
+        buildSettings.setPackNodeArrays (true);
+
+    if (args.removeIfFound ("--approximate-maths"))
+        buildSettings.setApproximateMaths (true);
+
+    if (args.removeIfFound ("--time-passes"))
+        buildSettings.setTimePasses (true);
+
+    if (args.removeIfFound ("--profile-nodes"))
+        buildSettings.setProfileNodes (true);
+
     return buildSettings;
 }
 
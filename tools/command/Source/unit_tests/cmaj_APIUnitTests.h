@@ -19,7 +19,12 @@
 #pragma once
 
 #include <map>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include "choc/text/choc_Files.h"
 #include "cmajor/API/cmaj_Engine.h"
+#include "cmajor/helpers/cmaj_PassTimings.h"
 
 namespace cmaj::api_tests
 {
@@ -398,6 +403,287 @@ namespace cmaj::api_tests
         CHOC_EXPECT_EQ (output, "111111");
     }
 
+    static void checkPassTimings (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkPassTimings);
+
+        auto engine = cmaj::Engine::create ({});
+        engine.setBuildSettings (cmaj::BuildSettings().setFrequency (44100.0)
+                                                      .setMaxBlockSize (10)
+                                                      .setTimePasses (true));
+
+        cmaj::Program program;
+        cmaj::DiagnosticMessageList messages;
+
+        program.parse (messages, "", source());
+        CHOC_EXPECT_TRUE (messages.empty());
+
+        CHOC_EXPECT_TRUE (engine.load (messages, program, [] (const cmaj::ExternalVariable&) { return choc::value::createFloat32 (2.0f); }, {}));
+        CHOC_EXPECT_TRUE (engine.link (messages, {}));
+
+        auto timings = cmaj::PassTimings::fromJSONString (engine.getLastPassTimings());
+        CHOC_EXPECT_TRUE (timings.has_value());
+        CHOC_EXPECT_FALSE (choc::text::startsWith (engine.getLastBuildLog(), "{"));
+
+        if (timings)
+        {
+            CHOC_EXPECT_TRUE (timings->getPass ("TypeResolver").runs > 0);
+            CHOC_EXPECT_TRUE (timings->getPass ("backendCodeGen").runs > 0);
+            CHOC_EXPECT_TRUE (timings->totalObjects > 0);
+            CHOC_EXPECT_FALSE (timings->objectClasses.empty());
+            CHOC_EXPECT_TRUE (timings->getObjectClass ("Namespace").numLive > 0);
+            CHOC_EXPECT_TRUE (timings->getObjectClass ("Namespace").numLive <= timings->getObjectClass ("Namespace").numAllocated);
+        }
+    }
+
+    static void checkNodeProfiling (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkNodeProfiling);
+
+        auto engine = cmaj::Engine::create ({});
+        engine.setBuildSettings (cmaj::BuildSettings().setFrequency (44100.0)
+                                                      .setMaxBlockSize (16)
+                                                      .setProfileNodes (true));
+
+        cmaj::Program program;
+        cmaj::DiagnosticMessageList messages;
+
+        program.parse (messages, "", R"(
+graph Test [[ main ]]
+{
+    output stream float out;
+
+    node gain1 = Gain;
+    node gain2 = Gain;
+
+    connection gain1 -> gain2 -> out;
+}
+
+processor Gain
+{
+    input stream float in;
+    output stream float out;
+
+    void main()
+    {
+        loop { out <- in * 0.5f + 1.0f; advance(); }
+    }
+}
+)");
+
+        CHOC_EXPECT_TRUE (messages.empty());
+        CHOC_EXPECT_TRUE (engine.load (messages, program, {}, {}));
+        CHOC_EXPECT_TRUE (engine.link (messages, {}));
+
+        auto performer = engine.createPerformer();
+        CHOC_EXPECT_TRUE (performer);
+
+        auto names = performer.getProfiledNodeNames();
+        CHOC_EXPECT_EQ (names.size(), 2u);
+
+        // render enough blocks that even a coarse timer will have ticked for each node
+        for (int i = 0; i < 1000; ++i)
+        {
+            performer.setBlockSize (16);
+            performer.advance();
+        }
+
+        uint64_t totals[4] = {};
+        CHOC_EXPECT_EQ (performer.getNodeProfile (totals, 4), 2u);
+        CHOC_EXPECT_TRUE (totals[0] > 0);
+        CHOC_EXPECT_TRUE (totals[1] > 0);
+    }
+
+    struct InMemoryCache  : public choc::com::ObjectWithAtomicRefCount<cmaj::CacheDatabaseInterface, InMemoryCache>
+    {
+        virtual ~InMemoryCache() = default;
+
+        void store (const char* key, const void* dataToSave, uint64_t dataSize) override
+        {
+            ++numStores;
+            auto d = static_cast<const char*> (dataToSave);
+            entries[key] = std::string (d, d + dataSize);
+        }
+
+        uint64_t reload (const char* key, void* destAddress, uint64_t destSize) override
+        {
+            auto found = entries.find (key);
+
+            if (found == entries.end())
+                return 0;
+
+            if (destAddress != nullptr && destSize >= found->second.size())
+            {
+                ++numReloads;
+                memcpy (destAddress, found->second.data(), found->second.size());
+            }
+
+            return found->second.size();
+        }
+
+        std::map<std::string, std::string> entries;
+        int numStores = 0, numReloads = 0;
+    };
+
+    static void checkModuleCache (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkModuleCache);
+
+        auto cache = choc::com::create<InMemoryCache>();
+
+        auto build = [&] (const std::string& code)
+        {
+            auto engine = cmaj::Engine::create ({});
+            engine.setBuildSettings (cmaj::BuildSettings().setFrequency (44100.0)
+                                                          .setMaxBlockSize (10));
+
+            cmaj::Program program;
+            cmaj::DiagnosticMessageList messages;
+
+            if (program.parse (messages, "test.cmajor", code, cache.get()))
+                if (engine.load (messages, program, [] (const cmaj::ExternalVariable&) { return choc::value::createFloat32 (2.0f); }, {}))
+                    engine.link (messages, {});
+
+            return messages.toString();
+        };
+
+        CHOC_EXPECT_EQ (build (source()), "");
+        CHOC_EXPECT_EQ (cache->numStores, 1);
+        CHOC_EXPECT_EQ (cache->numReloads, 0);
+
+        CHOC_EXPECT_EQ (build (source()), "");
+        CHOC_EXPECT_EQ (cache->numStores, 1);
+        CHOC_EXPECT_EQ (cache->numReloads, 1);
+
+        // errors from a cached module must still refer to the right place in the source
+        auto codeWithError = std::string (R"(
+            processor P
+            {
+                output stream float out;
+
+                void main()
+                {
+                    loop { out <- unknownThing; advance(); }
+                }
+            }
+        )");
+
+        auto firstErrors = build (codeWithError);
+        auto cachedErrors = build (codeWithError);
+
+        CHOC_EXPECT_TRUE (choc::text::contains (firstErrors, "test.cmajor:8:"));
+        CHOC_EXPECT_EQ (firstErrors, cachedErrors);
+        CHOC_EXPECT_EQ (cache->numStores, 2);
+        CHOC_EXPECT_EQ (cache->numReloads, 2);
+    }
+
+    static void checkParallelParsing (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkParallelParsing);
+
+        std::vector<cmaj::Program::File> files;
+
+        // there needs to be enough code here for parseFiles() to think it's worth sharing
+        // out between workers, on a machine with enough cores to do that
+        for (int i = 0; i < 20; ++i)
+        {
+            auto index = std::to_string (i);
+            std::string functions;
+
+            for (int j = 0; j < 100; ++j)
+                functions += "    float32 f" + std::to_string (j) + " (float32 x) { return x * " + std::to_string (j) + ".0f + " + index + ".0f; }\n";
+
+            files.push_back ({ "file" + index + ".cmajor",
+                               "namespace shared { int32 value" + index + "() { return " + index + "; } }\n"
+                               "processor P" + index + " { output stream float out; void main() { loop { out <- 1.0f; advance(); } } }\n"
+                               "namespace n" + index + "\n{\n" + functions + "}\n" });
+        }
+
+        auto getSyntaxTree = [] (cmaj::Program& p)
+        {
+            cmaj::SyntaxTreeOptions options;
+            options.includeSourceLocations = true;
+            options.includeFunctionContents = true;
+            return p.getSyntaxTree (options);
+        };
+
+        cmaj::Program serialProgram, parallelProgram;
+        cmaj::DiagnosticMessageList serialMessages, parallelMessages;
+
+        for (auto& f : files)
+            CHOC_EXPECT_TRUE (serialProgram.parse (serialMessages, f.filename, f.content));
+
+        CHOC_EXPECT_TRUE (parallelProgram.parseFiles (parallelMessages, files));
+        CHOC_EXPECT_EQ (getSyntaxTree (serialProgram), getSyntaxTree (parallelProgram));
+
+        // the error reported must be the one from the first bad file
+        files[7].content = "processor X { oops }";
+        files[12].content = "graph Y { wrong }";
+
+        cmaj::Program programWithErrors;
+        CHOC_EXPECT_FALSE (programWithErrors.parseFiles (parallelMessages, files));
+        CHOC_EXPECT_TRUE (choc::text::contains (parallelMessages.toString(), "file7.cmajor:1:"));
+        CHOC_EXPECT_FALSE (choc::text::contains (parallelMessages.toString(), "file12.cmajor"));
+    }
+
+    // Times a serial parse of the CompuFart example patch's files against parseFiles(). This only
+    // reports the times, as they depend on how many cores there are, and are too noisy to fail a test on
+    static void benchmarkParallelParsing (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (benchmarkParallelParsing);
+
+        auto patchFolder = std::filesystem::path (__FILE__).parent_path() / "../../../../examples/patches/CompuFart";
+        std::vector<cmaj::Program::File> files;
+
+        if (std::filesystem::is_directory (patchFolder))
+            for (auto& entry : std::filesystem::directory_iterator (patchFolder))
+                if (entry.path().extension() == ".cmajor")
+                    files.push_back ({ entry.path().filename().string(), choc::file::loadFileAsString (entry.path().string()) });
+
+        if (files.empty())
+        {
+            progress.print ("Couldn't find the example patch to time parsing with");
+            return;
+        }
+
+        std::sort (files.begin(), files.end(), [] (auto& a, auto& b) { return a.filename < b.filename; });
+
+        auto getBestTime = [] (auto&& parseProgram)
+        {
+            auto bestTime = std::chrono::duration<double, std::milli>::max();
+
+            for (int run = 0; run < 10; ++run)
+            {
+                auto start = std::chrono::steady_clock::now();
+                parseProgram();
+                bestTime = std::min (bestTime, std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now() - start));
+            }
+
+            return bestTime.count();
+        };
+
+        auto serialTime = getBestTime ([&]
+        {
+            cmaj::Program program;
+            cmaj::DiagnosticMessageList messages;
+
+            for (auto& f : files)
+                CHOC_EXPECT_TRUE (program.parse (messages, f.filename, f.content));
+        });
+
+        auto parallelTime = getBestTime ([&]
+        {
+            cmaj::Program program;
+            cmaj::DiagnosticMessageList messages;
+            CHOC_EXPECT_TRUE (program.parseFiles (messages, files));
+        });
+
+        progress.print ("Parsing " + std::to_string (files.size()) + " files took "
+                          + choc::text::floatToString (serialTime, 2) + " ms one at a time, and "
+                          + choc::text::floatToString (parallelTime, 2) + " ms with parseFiles(), using "
+                          + std::to_string (std::thread::hardware_concurrency()) + " cores");
+    }
+
     static void runUnitTests (choc::test::TestProgress& progress)
     {
         CHOC_CATEGORY (Performer);
@@ -406,5 +692,10 @@ namespace cmaj::api_tests
         checkGraph (progress);
         checkOutputEventWithMultipleTypes (progress);
         checkInvalidEngine (progress);
+        checkPassTimings (progress);
+        checkNodeProfiling (progress);
+        checkModuleCache (progress);
+        checkParallelParsing (progress);
+        benchmarkParallelParsing (progress);
     }
 }
@@ -0,0 +1,205 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+#pragma once
+
+#include <chrono>
+#include <thread>
+#include "choc/text/choc_Files.h"
+#include "../../../modules/playback/include/cmaj_AudioSources.h"
+
+namespace cmaj::audio_source_tests
+{
+    // A mono file whose samples count up from 1, so that a zero can only be silence
+    struct TestFile
+    {
+        TestFile (double sampleRate, uint32_t numFrames)
+            : temp (choc::file::TempFile::createRandomFilename ("cmaj_audio_source_test", "wav"))
+        {
+            choc::buffer::ChannelArrayBuffer<float> frames (1, numFrames);
+
+            for (uint32_t i = 0; i < numFrames; ++i)
+                frames.getSample (0, i) = getSample (i);
+
+            auto writer = cmaj::audio_utils::createFileWriter (temp.file.string(), sampleRate, 1);
+            writer->appendFrames (frames.getView());
+        }
+
+        static float getSample (uint32_t frame)   { return static_cast<float> (frame + 1); }
+
+        choc::file::TempFile temp;
+    };
+
+    // Reads blocks from the source until it has collected the given number of frames,
+    // skipping over the silence that's output while the background thread catches up
+    static std::vector<float> readFrames (Patch::CustomAudioSource& source, size_t numFrames)
+    {
+        std::vector<float> result;
+        choc::buffer::InterleavedBuffer<float> block (1, 256);
+        auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds (10);
+
+        while (result.size() < numFrames && std::chrono::steady_clock::now() < timeout)
+        {
+            source.read (block.getView());
+
+            for (uint32_t i = 0; i < block.getNumFrames() && result.size() < numFrames; ++i)
+                if (auto sample = block.getSample (0, i); sample != 0)
+                    result.push_back (sample);
+
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+        }
+
+        return result;
+    }
+
+    static bool isLoopOfFile (const std::vector<float>& frames, uint32_t fileLength, uint32_t firstFrame = 0)
+    {
+        for (size_t i = 0; i < frames.size(); ++i)
+            if (frames[i] != TestFile::getSample (static_cast<uint32_t> ((firstFrame + i) % fileLength)))
+                return false;
+
+        return ! frames.empty();
+    }
+
+    static void checkRingWrapAround (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkRingWrapAround);
+
+        // at 1kHz the ring holds 2000 frames, so this goes round it several times, and
+        // round the file more often than that
+        TestFile file (1000.0, 1500);
+        auto source = audio_utils::StreamingFilePlayerSource::createFromFile (file.temp.file.string());
+        CHOC_EXPECT_TRUE (source != nullptr);
+        source->prepare (1000.0);
+
+        auto frames = readFrames (*source, 7000);
+        CHOC_EXPECT_EQ (frames.size(), 7000u);
+        CHOC_EXPECT_TRUE (isLoopOfFile (frames, 1500));
+    }
+
+    static void checkUnderrun (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkUnderrun);
+
+        TestFile file (1000.0, 1500);
+        auto source = audio_utils::StreamingFilePlayerSource::createFromFile (file.temp.file.string());
+        source->prepare (1000.0);
+        std::this_thread::sleep_for (std::chrono::milliseconds (200));
+
+        // asking for more than the 2000 frames that the ring holds must give silence
+        // after whatever was there, rather than stale data
+        choc::buffer::InterleavedBuffer<float> block (1, 3000);
+        source->read (block.getView());
+
+        uint32_t numValid = 0;
+
+        while (numValid < block.getNumFrames() && block.getSample (0, numValid) != 0)
+            ++numValid;
+
+        CHOC_EXPECT_TRUE (numValid <= 2000);
+
+        for (uint32_t i = 0; i < numValid; ++i)
+            CHOC_EXPECT_EQ (block.getSample (0, i), TestFile::getSample (i % 1500));
+
+        for (uint32_t i = numValid; i < block.getNumFrames(); ++i)
+            CHOC_EXPECT_EQ (block.getSample (0, i), 0.0f);
+
+        // and playback must then carry on from where it stopped, without losing anything
+        std::vector<float> frames;
+
+        for (uint32_t i = 0; i < numValid; ++i)
+            frames.push_back (block.getSample (0, i));
+
+        for (auto f : readFrames (*source, 3000))
+            frames.push_back (f);
+
+        CHOC_EXPECT_TRUE (isLoopOfFile (frames, 1500));
+    }
+
+    static void checkPrepareWhilePlaying (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkPrepareWhilePlaying);
+
+        // changing the sample rate mustn't disturb a read that's running at the same time
+        TestFile file (1000.0, 1500);
+        auto source = audio_utils::StreamingFilePlayerSource::createFromFile (file.temp.file.string());
+        source->prepare (1000.0);
+
+        std::atomic<bool> finished { false };
+
+        std::thread audioThread ([&]
+        {
+            choc::buffer::InterleavedBuffer<float> block (1, 64);
+
+            while (! finished)
+                source->read (block.getView());
+        });
+
+        for (int i = 0; i < 50; ++i)
+        {
+            source->prepare (i % 2 == 0 ? 2000.0 : 1000.0);
+            std::this_thread::sleep_for (std::chrono::milliseconds (2));
+        }
+
+        finished = true;
+        audioThread.join();
+
+        // the last rate was 1kHz, so the file should be playing as normal, from wherever
+        // the other thread got up to
+        auto frames = readFrames (*source, 2000);
+        CHOC_EXPECT_EQ (frames.size(), 2000u);
+        CHOC_EXPECT_TRUE (isLoopOfFile (frames, 1500, frames.empty() ? 0 : static_cast<uint32_t> (frames.front()) - 1));
+    }
+
+    static void checkResampling (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkResampling);
+
+        // playing a 500Hz file at 1kHz should give the original samples on the even
+        // frames, with the odd ones interpolated half-way between them
+        TestFile file (500.0, 1000);
+        auto source = audio_utils::StreamingFilePlayerSource::createFromFile (file.temp.file.string());
+        source->prepare (1000.0);
+
+        auto frames = readFrames (*source, 2 * 1000 + 100);
+        CHOC_EXPECT_EQ (frames.size(), 2100u);
+
+        bool allCorrect = true;
+
+        for (uint32_t i = 0; i < frames.size(); ++i)
+        {
+            auto sourceFrame = (i / 2) % 1000;
+            auto expected = (i % 2) == 0 ? TestFile::getSample (sourceFrame)
+                                         : (TestFile::getSample (sourceFrame) + TestFile::getSample ((sourceFrame + 1) % 1000)) * 0.5f;
+
+            allCorrect = allCorrect && frames[i] == expected;
+        }
+
+        CHOC_EXPECT_TRUE (allCorrect);
+    }
+
+    static void runUnitTests (choc::test::TestProgress& progress)
+    {
+        CHOC_CATEGORY (AudioSources);
+
+        checkRingWrapAround (progress);
+        checkUnderrun (progress);
+        checkPrepareWhilePlaying (progress);
+        checkResampling (progress);
+    }
+}
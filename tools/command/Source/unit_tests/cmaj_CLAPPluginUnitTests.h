@@ -174,6 +174,14 @@ struct StubStereoAudioPortBackingData
     std::array<float*, 2> buffers { { left.data(), right.data() } };
 };
 
+template <size_t frameCount>
+struct StubStereoDoublePrecisionAudioPortBackingData
+{
+    std::array<double, frameCount> left {{}};
+    std::array<double, frameCount> right {{}};
+    std::array<double*, 2> buffers { { left.data(), right.data() } };
+};
+
 template <size_t ChannelCount, size_t FrameCount>
 struct StubAudioPortBackingData
 {
@@ -202,6 +210,19 @@ clap_audio_buffer_t toClapAudioBuffer (Backing&& backing)
     };
 }
 
+template <typename Backing>
+clap_audio_buffer_t toDoublePrecisionClapAudioBuffer (Backing&& backing)
+{
+    return
+    {
+        /*.data32 = */nullptr,
+        /*.data64 = */backing.buffers.data(),
+        /*.channel_count = */static_cast<uint32_t> (backing.buffers.size()),
+        /*.latency = */0,
+        /*.constant_mask = */0
+    };
+}
+
 struct HostData
 {
     using OnLatencyChangedFn = std::function<void()>;
@@ -2014,9 +2035,11 @@ inline void runUnitTests (choc::test::TestProgress& progress)
             CHOC_EXPECT_EQ (port->id, static_cast<uint32_t> (0));
             CHOC_EXPECT_EQ (std::string_view (port->name), std::string_view ("monoIn"));
             CHOC_EXPECT_TRUE (port->flags & CLAP_AUDIO_PORT_IS_MAIN);
+            CHOC_EXPECT_TRUE (port->flags & CLAP_AUDIO_PORT_SUPPORTS_64BITS);
+            CHOC_EXPECT_FALSE (port->flags & CLAP_AUDIO_PORT_PREFERS_64BITS);
             CHOC_EXPECT_EQ (port->channel_count, static_cast<uint32_t> (1));
             CHOC_EXPECT_EQ (std::string_view (port->port_type), std::string_view (CLAP_PORT_MONO));
-            CHOC_EXPECT_EQ (port->in_place_pair, CLAP_INVALID_ID);
+            CHOC_EXPECT_EQ (port->in_place_pair, static_cast<clap_id> (0));
         }
 
         {
@@ -2027,7 +2050,7 @@ inline void runUnitTests (choc::test::TestProgress& progress)
             CHOC_EXPECT_FALSE (port->flags & CLAP_AUDIO_PORT_IS_MAIN);
             CHOC_EXPECT_EQ (port->channel_count, static_cast<uint32_t> (2));
             CHOC_EXPECT_EQ (std::string_view (port->port_type), std::string_view (CLAP_PORT_STEREO));
-            CHOC_EXPECT_EQ (port->in_place_pair, CLAP_INVALID_ID);
+            CHOC_EXPECT_EQ (port->in_place_pair, static_cast<clap_id> (1));
         }
 
         {
@@ -2038,7 +2061,7 @@ inline void runUnitTests (choc::test::TestProgress& progress)
             CHOC_EXPECT_FALSE (port->flags & CLAP_AUDIO_PORT_IS_MAIN);
             CHOC_EXPECT_EQ (port->channel_count, static_cast<uint32_t> (3));
             CHOC_EXPECT_TRUE (port->port_type == nullptr);
-            CHOC_EXPECT_EQ (port->in_place_pair, CLAP_INVALID_ID);
+            CHOC_EXPECT_EQ (port->in_place_pair, static_cast<clap_id> (2));
         }
 
         {
@@ -2047,9 +2070,11 @@ inline void runUnitTests (choc::test::TestProgress& progress)
             CHOC_EXPECT_EQ (port->id, static_cast<uint32_t> (0));
             CHOC_EXPECT_EQ (std::string_view (port->name), std::string_view ("monoOut"));
             CHOC_EXPECT_TRUE (port->flags & CLAP_AUDIO_PORT_IS_MAIN);
+            CHOC_EXPECT_TRUE (port->flags & CLAP_AUDIO_PORT_SUPPORTS_64BITS);
+            CHOC_EXPECT_FALSE (port->flags & CLAP_AUDIO_PORT_PREFERS_64BITS);
             CHOC_EXPECT_EQ (port->channel_count, static_cast<uint32_t> (1));
             CHOC_EXPECT_EQ (std::string_view (port->port_type), std::string_view (CLAP_PORT_MONO));
-            CHOC_EXPECT_EQ (port->in_place_pair, CLAP_INVALID_ID);
+            CHOC_EXPECT_EQ (port->in_place_pair, static_cast<clap_id> (0));
         }
 
         {
@@ -2060,7 +2085,7 @@ inline void runUnitTests (choc::test::TestProgress& progress)
             CHOC_EXPECT_FALSE (port->flags & CLAP_AUDIO_PORT_IS_MAIN);
             CHOC_EXPECT_EQ (port->channel_count, static_cast<uint32_t> (2));
             CHOC_EXPECT_EQ (std::string_view (port->port_type), std::string_view (CLAP_PORT_STEREO));
-            CHOC_EXPECT_EQ (port->in_place_pair, CLAP_INVALID_ID);
+            CHOC_EXPECT_EQ (port->in_place_pair, static_cast<clap_id> (1));
         }
 
         {
@@ -2071,7 +2096,7 @@ inline void runUnitTests (choc::test::TestProgress& progress)
             CHOC_EXPECT_FALSE (port->flags & CLAP_AUDIO_PORT_IS_MAIN);
             CHOC_EXPECT_EQ (port->channel_count, static_cast<uint32_t> (3));
             CHOC_EXPECT_TRUE (port->port_type == nullptr);
-            CHOC_EXPECT_EQ (port->in_place_pair, CLAP_INVALID_ID);
+            CHOC_EXPECT_EQ (port->in_place_pair, static_cast<clap_id> (2));
         }
     }
 
@@ -2173,6 +2198,213 @@ inline void runUnitTests (choc::test::TestProgress& progress)
         CHOC_EXPECT_NEAR (outputBacking.right[3], 0.75f, 0.0001f);
     }
 
+    {
+        CHOC_TEST (ProcessPluginWithDoublePrecisionAudioPorts)
+
+        // setup
+        StubHost host {};
+
+        const clap_plugin_descriptor_t descriptor {};
+
+        const auto manifestSource = R"({
+            "CmajorVersion": 1,
+            "ID": "com.your-name.your-patch-id",
+            "version": "1.0",
+            "name": "Test",
+            "description": "Test",
+            "category": "effect",
+            "manufacturer": "Your Company Goes Here",
+            "isInstrument": false,
+
+            "source": ["test.cmajor"]
+        })";
+
+        const auto cmajorSource = R"(
+            graph Test [[ main ]]
+            {
+                input stream float64<2> in;
+                output stream float64<2> out;
+
+                connection in * 0.5 -> out;
+            }
+        )";
+
+        const auto vfs = createJITEnvironmentWithInMemoryFileSystem ({
+            { "test.cmajorpatch", manifestSource },
+            { "test.cmajor", cmajorSource }
+        });
+
+        auto plugin = cmaj::plugin::clap::create (descriptor, host, "test.cmajorpatch", vfs);
+
+        CHOC_ASSERT (plugin != nullptr);
+
+        plugin->init (plugin.get());
+
+        const double frequency = 4;
+        constexpr uint32_t minBlockSize = 4;
+        constexpr uint32_t maxBlockSize = 4;
+
+        ScopedActivator deactivateOnExit { *plugin, frequency, minBlockSize, maxBlockSize }; // N.B. main-thread
+        CHOC_ASSERT (deactivateOnExit.activated);
+
+        {
+            const auto port = getPortInfo (*plugin, 0, true);
+            CHOC_ASSERT (port);
+            CHOC_EXPECT_TRUE (port->flags & CLAP_AUDIO_PORT_SUPPORTS_64BITS);
+            CHOC_EXPECT_TRUE (port->flags & CLAP_AUDIO_PORT_PREFERS_64BITS);
+        }
+
+        StubStereoDoublePrecisionAudioPortBackingData<minBlockSize> inputBacking;
+        StubStereoDoublePrecisionAudioPortBackingData<minBlockSize> outputBacking;
+
+        auto inputs = toDoublePrecisionClapAudioBuffer (inputBacking);
+        std::fill (inputBacking.left.begin(), inputBacking.left.end(), 0.123456789012345);
+        std::fill (inputBacking.right.begin(), inputBacking.right.end(), -0.987654321098765);
+
+        auto outputs = toDoublePrecisionClapAudioBuffer (outputBacking);
+
+        using EventQueueContext = std::vector<clap_event_param_value_t>;
+        EventQueueContext inputEventQueueContext {};
+        const auto inputEventQueue = toInputEventQueue<EventQueueContext> (inputEventQueueContext);
+
+        // execute
+        {
+            CHOC_EXPECT_TRUE (plugin->start_processing (plugin.get())); // N.B. audio-thread
+            const clap_process_t process
+            {
+                /*.steady_time = */-1,
+                /*.frames_count = */minBlockSize,
+                /*.transport = */nullptr, // free-running
+                /*.audio_inputs = */std::addressof (inputs),
+                /*.audio_outputs = */std::addressof (outputs),
+                /*.audio_inputs_count = */1,
+                /*.audio_outputs_count = */1,
+                /*.in_events = */std::addressof (inputEventQueue),
+                /*.out_events = */nullptr
+            };
+
+            CHOC_EXPECT_EQ (plugin->process (plugin.get(), std::addressof (process)), CLAP_PROCESS_CONTINUE);
+
+            plugin->stop_processing (plugin.get()); // N.B. audio-thread
+        }
+
+        // verify - the values must survive with better than single-precision accuracy
+        for (size_t i = 0; i < minBlockSize; ++i)
+        {
+            CHOC_EXPECT_NEAR (outputBacking.left[i], 0.0617283945061725, 1.0e-14);
+            CHOC_EXPECT_NEAR (outputBacking.right[i], -0.4938271605493825, 1.0e-14);
+        }
+    }
+
+    {
+        CHOC_TEST (ProcessPluginInPlace)
+
+        // setup
+        StubHost host {};
+
+        const clap_plugin_descriptor_t descriptor {};
+
+        const auto manifestSource = R"({
+            "CmajorVersion": 1,
+            "ID": "com.your-name.your-patch-id",
+            "version": "1.0",
+            "name": "Test",
+            "description": "Test",
+            "category": "effect",
+            "manufacturer": "Your Company Goes Here",
+            "isInstrument": false,
+
+            "source": ["test.cmajor"]
+        })";
+
+        const auto cmajorSource = R"(
+            processor Test [[ main ]]
+            {
+                input stream float32 monoIn;
+                input stream float32<2> stereoIn;
+
+                output stream float32 monoOut;
+                output stream float32<2> stereoOut;
+
+                void main()
+                {
+                    loop
+                    {
+                        monoOut <- monoIn * 2.0f;
+                        stereoOut <- stereoIn.yx;
+
+                        advance();
+                    }
+                }
+            }
+        )";
+
+        const auto vfs = createJITEnvironmentWithInMemoryFileSystem ({
+            { "test.cmajorpatch", manifestSource },
+            { "test.cmajor", cmajorSource }
+        });
+
+        auto plugin = cmaj::plugin::clap::create (descriptor, host, "test.cmajorpatch", vfs);
+
+        CHOC_ASSERT (plugin != nullptr);
+
+        plugin->init (plugin.get());
+
+        const double frequency = 4;
+        constexpr uint32_t minBlockSize = 4;
+        constexpr uint32_t maxBlockSize = 4;
+
+        ScopedActivator deactivateOnExit { *plugin, frequency, minBlockSize, maxBlockSize }; // N.B. main-thread
+        CHOC_ASSERT (deactivateOnExit.activated);
+
+        StubAudioPortBackingData<1, minBlockSize> monoBacking;
+        StubAudioPortBackingData<2, minBlockSize> stereoBacking;
+
+        std::fill (monoBacking.channels[0].begin(), monoBacking.channels[0].end(), 0.25f);
+        std::fill (stereoBacking.channels[0].begin(), stereoBacking.channels[0].end(), 0.1f);
+        std::fill (stereoBacking.channels[1].begin(), stereoBacking.channels[1].end(), 0.2f);
+
+        // the host passes the same buffers for both inputs and outputs
+        std::array<clap_audio_buffer_t, 2> buffers
+        {{
+            toClapAudioBuffer (monoBacking),
+            toClapAudioBuffer (stereoBacking),
+        }};
+
+        using EventQueueContext = std::vector<clap_event_param_value_t>;
+        EventQueueContext inputEventQueueContext {};
+        const auto inputEventQueue = toInputEventQueue<EventQueueContext> (inputEventQueueContext);
+
+        // execute
+        {
+            CHOC_EXPECT_TRUE (plugin->start_processing (plugin.get())); // N.B. audio-thread
+            const clap_process_t process
+            {
+                /*.steady_time = */-1,
+                /*.frames_count = */minBlockSize,
+                /*.transport = */nullptr, // free-running
+                /*.audio_inputs = */buffers.data(),
+                /*.audio_outputs = */buffers.data(),
+                /*.audio_inputs_count = */static_cast<uint32_t> (buffers.size()),
+                /*.audio_outputs_count = */static_cast<uint32_t> (buffers.size()),
+                /*.in_events = */std::addressof (inputEventQueue),
+                /*.out_events = */nullptr
+            };
+
+            CHOC_EXPECT_EQ (plugin->process (plugin.get(), std::addressof (process)), CLAP_PROCESS_CONTINUE);
+
+            plugin->stop_processing (plugin.get()); // N.B. audio-thread
+        }
+
+        // verify
+        for (size_t i = 0; i < minBlockSize; ++i)
+        {
+            CHOC_EXPECT_NEAR (monoBacking.channels[0][i], 0.5f, 0.0001f);
+            CHOC_EXPECT_NEAR (stereoBacking.channels[0][i], 0.2f, 0.0001f);
+            CHOC_EXPECT_NEAR (stereoBacking.channels[1][i], 0.1f, 0.0001f);
+        }
+    }
+
     {
         CHOC_TEST (ProcessPluginWithMultipleInputAndOutputAudioPorts)
 
@@ -3750,7 +3982,7 @@ inline void runUnitTests (choc::test::TestProgress& progress)
                 CHOC_EXPECT_TRUE (port->flags & CLAP_AUDIO_PORT_IS_MAIN);
                 CHOC_EXPECT_EQ (port->channel_count, static_cast<uint32_t> (2));
                 CHOC_EXPECT_EQ (std::string_view (port->port_type), std::string_view (CLAP_PORT_STEREO));
-                CHOC_EXPECT_EQ (port->in_place_pair, CLAP_INVALID_ID);
+                CHOC_EXPECT_EQ (port->in_place_pair, static_cast<clap_id> (0));
             }
 
             {
@@ -3761,7 +3993,7 @@ inline void runUnitTests (choc::test::TestProgress& progress)
                 CHOC_EXPECT_TRUE (port->flags & CLAP_AUDIO_PORT_IS_MAIN);
                 CHOC_EXPECT_EQ (port->channel_count, static_cast<uint32_t> (2));
                 CHOC_EXPECT_EQ (std::string_view (port->port_type), std::string_view (CLAP_PORT_STEREO));
-                CHOC_EXPECT_EQ (port->in_place_pair, CLAP_INVALID_ID);
+                CHOC_EXPECT_EQ (port->in_place_pair, static_cast<clap_id> (0));
             }
         }
 
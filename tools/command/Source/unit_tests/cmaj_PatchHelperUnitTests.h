@@ -1149,6 +1149,108 @@ static bool runUnitTests (choc::test::TestProgress& progress)
         CHOC_EXPECT_NEAR (outputBackingBuffer[3], 0.125f, 0.0001f);
     }
 
+    {
+        CHOC_TEST (RebuildWhilstProcessingDoesNotInterruptAudio)
+
+        const auto manifestSource = R"({
+            "CmajorVersion": 1,
+            "ID": "com.your_name.your_patch_ID",
+            "version": "1.0",
+            "name": "Test",
+            "description": "Test",
+            "category": "generator",
+            "manufacturer": "Your Company Goes Here",
+            "isInstrument": false,
+
+            "source": ["Test.cmajor"]
+        })";
+
+        const auto createSource = [] (int outputLevel)
+        {
+            return choc::text::replace (R"(
+                processor Test [[ main ]]
+                {
+                    output stream float out;
+
+                    void main()
+                    {
+                        loop
+                        {
+                            out <- LEVEL.0f;
+                            advance();
+                        }
+                    }
+                }
+            )", "LEVEL", std::to_string (outputLevel));
+        };
+
+        const std::array<std::string, 3> sources { {}, createSource (1), createSource (2) };
+
+        Patch patch;
+        initTestPatch (patch);
+
+        std::atomic<bool> playbackWasStopped { false };
+        patch.stopPlayback = [&] { playbackWasStopped = true; };
+
+        cmaj::Patch::PlaybackParams params;
+        params.blockSize = 32;
+        params.sampleRate = 44100;
+        params.numInputChannels = 0;
+        params.numOutputChannels = 1;
+        patch.setPlaybackParams (params);
+
+        if (! patch.loadPatch ({ createManifestWithInMemoryFiles (manifestSource, {{ "Test.cmajor", sources[1] }}), {} }, true))
+        {
+            CHOC_FAIL ("Failed to load patch");
+            return false;
+        }
+
+        std::atomic<bool> audioThreadShouldStop { false };
+        std::atomic<uint32_t> numBlocks { 0 }, numUnexpectedBlocks { 0 };
+        std::array<std::atomic<uint32_t>, 3> numBlocksWithLevel {};
+
+        std::thread audioThread ([&]
+        {
+            std::array<float, 32> buffer {};
+            std::array<float*, 1> buffers { { buffer.data() } };
+
+            while (! audioThreadShouldStop)
+            {
+                patch.process (buffers.data(), static_cast<uint32_t> (buffer.size()), [] (auto&&...) {});
+
+                auto level = static_cast<int> (buffer[0]);
+
+                if (buffer[0] != static_cast<float> (level) || level < 1 || level > 2
+                     || std::any_of (buffer.begin(), buffer.end(), [&] (float f) { return f != buffer[0]; }))
+                    ++numUnexpectedBlocks;
+                else
+                    ++numBlocksWithLevel[static_cast<size_t> (level)];
+
+                ++numBlocks;
+            }
+        });
+
+        for (int i = 0; i < 4; ++i)
+        {
+            auto level = static_cast<size_t> (2 - (i & 1));
+
+            if (! patch.loadPatch ({ createManifestWithInMemoryFiles (manifestSource, {{ "Test.cmajor", sources[level] }}), {} }, true))
+                CHOC_FAIL ("Failed to rebuild patch");
+
+            // let the audio thread render a few blocks with each version
+            for (auto blocksAtStart = numBlocks.load(); numBlocks < blocksAtStart + 10;)
+                std::this_thread::yield();
+        }
+
+        audioThreadShouldStop = true;
+        audioThread.join();
+
+        CHOC_EXPECT_FALSE (playbackWasStopped);
+        CHOC_EXPECT_EQ (numUnexpectedBlocks.load(), 0u);
+        CHOC_EXPECT_TRUE (numBlocksWithLevel[1] > 0);
+        CHOC_EXPECT_TRUE (numBlocksWithLevel[2] > 0);
+    }
+
     return progress.numFails == 0;
 }
 
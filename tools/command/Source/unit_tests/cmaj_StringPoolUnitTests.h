@@ -0,0 +1,151 @@
+//
+//     ,ad888ba,                              88
+//    d8"'    "8b
+//   d8            88,dba,,adba,   ,aPP8A.A8  88     The Cmajor Toolkit
+//   Y8,           88    88    88  88     88  88
+//    Y8a.   .a8P  88    88    88  88,   ,88  88     (C)2024 Cmajor Software Ltd
+//     '"Y888Y"'   88    88    88  '"8bbP"Y8  88     https://cmajor.dev
+//                                           ,88
+//                                        888P"
+//
+//  The Cmajor project is subject to commercial or open-source licensing.
+//  You may use it under the terms of the GPLv3 (see www.gnu.org/licenses), or
+//  visit https://cmajor.dev to learn about our commercial licence options.
+//
+//  CMAJOR IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+//  EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+//  DISCLAIMED.
+
+#pragma once
+
+#include <chrono>
+#include "../../../modules/compiler/src/AST/cmaj_AST.h"
+
+namespace cmaj::string_pool_tests
+{
+    // A mix of the short names that fit in std::string's small buffer and the longer
+    // ones that don't, like the identifiers that the parser interns
+    static std::vector<std::string> createIdentifiers()
+    {
+        std::vector<std::string> names;
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            names.push_back ("v" + std::to_string (i));
+            names.push_back ("processorStateVariable_" + std::to_string (i));
+        }
+
+        return names;
+    }
+
+    static void checkInterning (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (checkInterning);
+
+        choc::memory::Pool pool;
+        AST::StringPool strings (pool);
+
+        auto names = createIdentifiers();
+        std::vector<AST::PooledString> pooled;
+
+        for (auto& name : names)
+            pooled.push_back (strings.get (name));
+
+        // the map has been re-hashed many times by now, so this checks that its keys still
+        // point at the right text
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            CHOC_EXPECT_TRUE (pooled[i] == std::string_view (names[i]));
+            CHOC_EXPECT_TRUE (strings.get (names[i]) == pooled[i]);
+            CHOC_EXPECT_TRUE (strings.get (std::string_view (names[i])) == pooled[i]);
+            CHOC_EXPECT_TRUE (strings.get (names[i].c_str()) == pooled[i]);
+        }
+
+        CHOC_EXPECT_TRUE (strings.get (std::string()).empty());
+        CHOC_EXPECT_TRUE (strings.get ("").empty());
+    }
+
+    // All the names in the standard library, in the order they appear in its syntax tree,
+    // with repeats, so that lookups of them are like the ones made while parsing it
+    static std::vector<std::string> getStandardLibraryNames()
+    {
+        struct NameCollector  : public AST::Visitor
+        {
+            using AST::Visitor::Visitor;
+
+            void visitObject (AST::Object& o) override
+            {
+                if (auto name = o.getName(); ! name.empty())
+                    names.emplace_back (name.get());
+
+                AST::Visitor::visitObject (o);
+            }
+
+            std::vector<std::string> names;
+        };
+
+        AST::Program program;
+        program.prepareForLoading();
+
+        NameCollector collector (program.allocator);
+        collector.visitObject (program.rootNamespace);
+        return std::move (collector.names);
+    }
+
+    // Times lookups of the standard library's names once they're in the pool, against a map
+    // keyed by std::string, which is how the pool used to store them. This only reports the
+    // times, as they're too noisy to fail a test on
+    static void benchmarkLookups (choc::test::TestProgress& progress)
+    {
+        CHOC_TEST (benchmarkLookups);
+
+        constexpr int numRepetitions = 50;
+        auto names = getStandardLibraryNames();
+        CHOC_EXPECT_TRUE (names.size() > 1000);
+
+        auto timeLookups = [&] (auto&& lookup)
+        {
+            auto bestTime = std::chrono::duration<double, std::milli>::max();
+
+            for (int run = 0; run < 10; ++run)
+            {
+                auto start = std::chrono::steady_clock::now();
+
+                for (int i = 0; i < numRepetitions; ++i)
+                    for (auto& name : names)
+                        lookup (std::string_view (name));
+
+                bestTime = std::min (bestTime, std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now() - start));
+            }
+
+            return bestTime.count();
+        };
+
+        choc::memory::Pool pool;
+        AST::StringPool strings (pool);
+        size_t numEmpty = 0;
+
+        auto pooledTime = timeLookups ([&] (std::string_view name) { numEmpty += strings.get (name).empty() ? 1 : 0; });
+
+        std::unordered_map<std::string, AST::PooledString> stringKeyedMap;
+
+        for (auto& name : names)
+            stringKeyedMap[name] = strings.get (name);
+
+        auto stringKeyedTime = timeLookups ([&] (std::string_view name) { numEmpty += stringKeyedMap[std::string (name)].empty() ? 1 : 0; });
+
+        CHOC_EXPECT_EQ (numEmpty, 0u);
+
+        progress.print ("StringPool: " + std::to_string (names.size() * numRepetitions) + " lookups of standard library names took "
+                          + choc::text::floatToString (pooledTime, 2) + " ms, against "
+                          + choc::text::floatToString (stringKeyedTime, 2) + " ms with std::string keys");
+    }
+
+    static void runUnitTests (choc::test::TestProgress& progress)
+    {
+        CHOC_CATEGORY (StringPool);
+
+        checkInterning (progress);
+        benchmarkLookups (progress);
+    }
+}